@@ -3,9 +3,109 @@
 #include <iostream>
 #include <random>
 #include <algorithm>
+#include <fstream>
+#include <string>
+#include <cstdint>
+#include <limits>
+#include <bitset>
 
 using Clock = std::chrono::high_resolution_clock;
 
+/*/
+Energy measurement with RAPL (Running Average Power Limit).
+On Linux with Intel (and recent AMD) cpus, the kernel exposes cumulative energy counters in microjoules under
+/sys/class/powercap/intel-rapl:N (package) and intel-rapl:N:M (subdomains like "dram" or "core").
+We read them before and after a run and take the difference, counters wrap at max_energy_range_uj so we handle that too.
+If a counter wrapped and max_energy_range_uj couldn't be read, that domain is marked invalid for the run and printed as n/a.
+If the counters are not there (other OS, VM, no permission to read energy_uj) available() returns false and we just skip energy.
+*/
+struct EnergyReading
+{
+    double packageJoules = 0;
+    double dramJoules = 0;
+    bool packageValid = true; // false if a counter wrapped and we don't know its range, the joules are meaningless then
+    bool dramValid = true;
+
+    void add(const EnergyReading& run)
+    {
+        packageJoules += run.packageJoules, dramJoules += run.dramJoules;
+        packageValid &= run.packageValid, dramValid &= run.dramValid;
+    }
+
+    EnergyReading averaged(int runs) const
+    {
+        EnergyReading r = *this;
+        r.packageJoules /= runs, r.dramJoules /= runs;
+        return r;
+    }
+};
+
+class RaplMeter
+{
+    struct Domain
+    {
+        std::string path;
+        bool dram;
+        unsigned long long maxRange;
+        unsigned long long start = 0;
+    };
+    std::vector<Domain> domains;
+
+    static bool readValue(const std::string& file, unsigned long long& value)
+    {
+        std::ifstream in(file);
+        return static_cast<bool>(in >> value);
+    }
+
+public:
+    RaplMeter()
+    {
+        for (int pkg = 0; pkg < 16; pkg++)
+        {
+            std::string base = "/sys/class/powercap/intel-rapl:" + std::to_string(pkg);
+            for (int sub = -1; sub < 8; sub++)
+            {
+                std::string dir = sub < 0 ? base : base + ":" + std::to_string(sub);
+                std::ifstream nameFile(dir + "/name");
+                std::string name;
+                if (!(nameFile >> name)) continue;
+                bool isPackage = name.rfind("package", 0) == 0;
+                bool isDram = name == "dram";
+                if (!isPackage && !isDram) continue; // core/uncore are already counted in the package
+                unsigned long long value, maxRange;
+                if (!readValue(dir + "/energy_uj", value)) continue; // usually root-only on newer kernels
+                if (!readValue(dir + "/max_energy_range_uj", maxRange)) maxRange = 0;
+                domains.push_back({ dir + "/energy_uj", isDram, maxRange });
+            }
+        }
+    }
+
+    bool available() const { return !domains.empty(); }
+
+    void start()
+    {
+        for (auto& d : domains) readValue(d.path, d.start);
+    }
+
+    EnergyReading stop()
+    {
+        EnergyReading reading;
+        for (auto& d : domains)
+        {
+            unsigned long long now = d.start;
+            readValue(d.path, now);
+            if (now < d.start && d.maxRange == 0) // wrapped, but max_energy_range_uj wasn't readable
+            {
+                (d.dram ? reading.dramValid : reading.packageValid) = false;
+                continue;
+            }
+            unsigned long long delta = now >= d.start ? now - d.start : now + d.maxRange - d.start; // counter wrapped around
+            (d.dram ? reading.dramJoules : reading.packageJoules) += delta * 1e-6;
+        }
+        return reading;
+    }
+};
+
 struct ParticleAos
 {
     float x, y, z;
@@ -16,16 +116,69 @@ struct ParticleAos
 struct ParticlesSoA
 {
     std::vector<float> x, y, z, mass;
+    std::vector<uint64_t> validX, validMass; // optional validity bitmaps, bit k = 1 means row k has a value, empty = no nulls
     ParticlesSoA(size_t n)
     {
         x.resize(n), y.resize(n), z.resize(n), mass.resize(n);
     }
+
+    // first null in a column allocates its bitmap with every row valid
+    static void setNull(std::vector<uint64_t>& valid, size_t n, size_t k)
+    {
+        if (valid.empty()) valid.assign((n + 63) / 64, ~0ull);
+        valid[k / 64] &= ~(1ull << (k % 64));
+    }
 };
 
-double benchmarkAoS(size_t n, int repeats = 5)/*
+/*/
+Nullable kernels. Instead of NaN sentinels (which need an extra compare per value and make x > 0 silently false),
+missing values live in validity bitmaps, and the kernels work 64 rows at a time:
+1. build the predicate mask for 64 rows (x > 0), branchless
+2. AND it with the validity words of every column the kernel reads, one instruction for 64 rows
+3. sum mass where the final mask bit is set, again branchless
+Columns without nulls have an empty bitmap and skip step 2 for that column.
+*/
+inline uint64_t predicateMask(const float* x, size_t count)
+{
+    uint64_t mask = 0;
+    for (size_t j = 0; j < count; j++) mask |= uint64_t(x[j] > 0.0f) << j;
+    return mask;
+}
+
+double maskedSum(const ParticlesSoA& p)
+{
+    size_t n = p.x.size();
+    double sum = 0;
+    for (size_t w = 0; w * 64 < n; w++)
+    {
+        size_t begin = w * 64, count = std::min<size_t>(64, n - begin);
+        uint64_t mask = predicateMask(&p.x[begin], count);
+        if (!p.validX.empty()) mask &= p.validX[w];
+        if (!p.validMass.empty()) mask &= p.validMass[w];
+        for (size_t j = 0; j < count; j++) sum += (mask >> j & 1) ? p.mass[begin + j] : 0.0f;
+    }
+    return sum;
+}
+
+// filter: selection bitmap of valid rows with x > 0, so later kernels can reuse it
+std::vector<uint64_t> filterPositiveX(const ParticlesSoA& p)
+{
+    size_t n = p.x.size();
+    std::vector<uint64_t> selection((n + 63) / 64);
+    for (size_t w = 0; w < selection.size(); w++)
+    {
+        size_t begin = w * 64;
+        uint64_t mask = predicateMask(&p.x[begin], std::min<size_t>(64, n - begin));
+        selection[w] = p.validX.empty() ? mask : mask & p.validX[w];
+    }
+    return selection;
+}
+
+double benchmarkAoS(size_t n, int repeats = 5, EnergyReading* energy = nullptr)/*
                                                 benchmark:
                                                 - n: number of particles
                                                 - repeats: how many times to repeat the loop (best time is taken)
+                                                - energy: if not null and RAPL is available, filled with average energy of one run
                                                 Returns: best execution time in seconds
                                               */
 {
@@ -33,9 +186,12 @@ double benchmarkAoS(size_t n, int repeats = 5)/*
     std::mt19937_64 rng(123); // we hardcode seed so we have same random values every test to ensure reproducibility
     std::uniform_real_distribution<float> dist(-1000.f, 1000.f); //we define random distribution in range -1000 1000
     for (size_t i = 0; i < n; i++) particles.push_back({ dist(rng), dist(rng), dist(rng), dist(rng) });
+    RaplMeter meter;
+    EnergyReading total;
     double bestTime = 1e300;
     for (size_t i = 0; i < repeats; i++)
     {
+        meter.start();
         auto startTime = Clock::now();
         double sum = 0;
         for (size_t k = 0; k < n; k++)
@@ -43,15 +199,17 @@ double benchmarkAoS(size_t n, int repeats = 5)/*
             if (particles[k].x > 0.0f) sum += particles[k].mass;
         }
         auto endTime = Clock::now();
+        EnergyReading run = meter.stop();
+        total.add(run);
         std::chrono::duration<double> duration = endTime - startTime;
         bestTime = std::min(bestTime, duration.count());
         if (sum == 0) std::cout << ""; // with this line we prevent optimizing away, we basically trick compiler to think sum is used so it doesnt optimize the loop away entirely aka Dummy read
     }
-
+    if (energy) *energy = total.averaged(repeats);
     return bestTime;
 }
 
-double benchmarkSoA(size_t n, int repeats = 5)
+double benchmarkSoA(size_t n, int repeats = 5, EnergyReading* energy = nullptr)
 {
     ParticlesSoA particles(n);
     std::mt19937_64 rng(123);
@@ -62,9 +220,12 @@ double benchmarkSoA(size_t n, int repeats = 5)
         particles.z[i] = dist(rng);
         particles.mass[i] = dist(rng);
     }
+    RaplMeter meter;
+    EnergyReading total;
     double bestTime = 1e300;
     for (size_t i = 0; i < repeats; i++)
     {
+        meter.start();
         auto startTime = Clock::now();
         double sum = 0;
         for (size_t k = 0; k < particles.x.size(); k++)
@@ -72,6 +233,57 @@ double benchmarkSoA(size_t n, int repeats = 5)
             if (particles.x[k] > 0.0f) sum += particles.mass[k];
         }
         auto endTime = Clock::now();
+        EnergyReading run = meter.stop();
+        total.add(run);
+        std::chrono::duration<double> duration = endTime - startTime;
+        bestTime = std::min(bestTime, duration.count());
+        if (sum == 0) std::cout << "";
+    }
+    if (energy) *energy = total.averaged(repeats);
+    return bestTime;
+}
+
+/*/
+benchmarkSoANullable:
+- nullDensity: fraction of rows where x and mass are missing (independently)
+- useBitmaps: true = validity bitmaps + maskedSum, false = NaN sentinels in the plain loop
+- filter: time filterPositiveX (selection bitmap, we count the selected rows) instead of the masked sum. With NaN
+  sentinels there is no validX, and NaN > 0 is false, so the same kernel just skips the AND
+Returns: best execution time in seconds
+*/
+double benchmarkSoANullable(size_t n, double nullDensity, bool useBitmaps, bool filter = false, int repeats = 5)
+{
+    ParticlesSoA particles(n);
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const float NaN = std::numeric_limits<float>::quiet_NaN();
+    for (size_t i = 0; i < n; i++) {
+        particles.x[i] = dist(rng);
+        particles.y[i] = dist(rng);
+        particles.z[i] = dist(rng);
+        particles.mass[i] = dist(rng);
+        if (unit(rng) < nullDensity) useBitmaps ? ParticlesSoA::setNull(particles.validX, n, i) : void(particles.x[i] = NaN);
+        if (unit(rng) < nullDensity) useBitmaps ? ParticlesSoA::setNull(particles.validMass, n, i) : void(particles.mass[i] = NaN);
+    }
+    double bestTime = 1e300;
+    for (size_t i = 0; i < repeats; i++)
+    {
+        auto startTime = Clock::now();
+        double sum = 0;
+        if (filter)
+        {
+            size_t selected = 0;
+            for (uint64_t word : filterPositiveX(particles)) selected += std::bitset<64>(word).count();
+            sum = double(selected);
+        }
+        else if (useBitmaps) sum = maskedSum(particles);
+        else
+            for (size_t k = 0; k < particles.x.size(); k++)
+            {
+                if (particles.x[k] > 0.0f && particles.mass[k] == particles.mass[k]) sum += particles.mass[k]; // NaN != NaN
+            }
+        auto endTime = Clock::now();
         std::chrono::duration<double> duration = endTime - startTime;
         bestTime = std::min(bestTime, duration.count());
         if (sum == 0) std::cout << "";
@@ -82,12 +294,38 @@ double benchmarkSoA(size_t n, int repeats = 5)
 int main()
 {
     const size_t N = 5'000'000; // use this to modify how many particles you want created
-    double benchmarkAoSTime = benchmarkAoS(N);
-    double benchmarkSoATime = benchmarkSoA(N);
+    EnergyReading aosEnergy, soaEnergy;
+    double benchmarkAoSTime = benchmarkAoS(N, 5, &aosEnergy);
+    double benchmarkSoATime = benchmarkSoA(N, 5, &soaEnergy);
     std::cout << "AoS time: " << benchmarkAoSTime << " s\n";// you can also add second argument to modify how many repeats you want
     std::cout << "SoA time: " << benchmarkSoATime << " s\n";
     std::cout << "Time difference: " << benchmarkAoSTime - benchmarkSoATime << std::endl;
+    if (RaplMeter().available())
+    {
+        auto print = [&](const char* name, const EnergyReading& e) { // n/a when a counter wrapped with unknown range
+            std::cout << name << " energy: ";
+            if (e.packageValid) std::cout << e.packageJoules / N * 1e9; else std::cout << "n/a";
+            std::cout << " nJ/element (package), ";
+            if (e.dramValid) std::cout << e.dramJoules / N * 1e9; else std::cout << "n/a";
+            std::cout << " nJ/element (dram)\n";
+        };
+        print("AoS", aosEnergy);
+        print("SoA", soaEnergy);
+    }
+    else std::cout << "Energy: RAPL counters not available, skipping\n";
     std::cout << "This shows us that using SoA if we have field-centric operations can improve time duration by a lot." << std::endl;
+
+    std::cout << "\nNullable SoA (x > 0 -> sum mass, nulls skipped), compared to SoA time above\n";
+    for (double density : { 0.0, 0.01, 0.1, 0.5 })
+    {
+        double sentinel = benchmarkSoANullable(N, density, false);
+        double bitmap = benchmarkSoANullable(N, density, true);
+        double sentinelFilter = benchmarkSoANullable(N, density, false, true);
+        double bitmapFilter = benchmarkSoANullable(N, density, true, true);
+        std::cout << "null density " << density * 100 << "%: masked sum: NaN sentinels " << sentinel << " s, validity bitmaps " << bitmap
+            << " s, bitmap overhead vs SoA " << (bitmap / benchmarkSoATime - 1.0) * 100 << "%\n";
+        std::cout << "                   filter x > 0: NaN sentinels " << sentinelFilter << " s, validity bitmaps " << bitmapFilter << " s\n";
+    }
     return 0;
 }
 
@@ -0,0 +1,414 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+Other tools (pandas, polars, DuckDB, ...) speak the Arrow columnar format, and SoA is already almost Arrow:
+one contiguous array per field. What Arrow adds on top:
+- value buffers 64-byte aligned and padded to a multiple of 64 bytes
+- optional validity bitmap per column (bit i = 1 means row i is not null, least significant bit first)
+- variable-length data (strings) as an int32 offsets buffer (n + 1 entries) plus one data buffer
+If our table keeps its columns in exactly this layout, handing them over is zero-copy: we only fill the two small
+C Data Interface structs (ArrowSchema, ArrowArray) with pointers into our buffers. No Arrow library needed, the structs
+are a stable C ABI, so we just declare them here like the spec says to.
+*/
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+#endif
+
+
+// ---------- 64-byte aligned buffers ----------
+
+constexpr size_t ARROW_ALIGNMENT = 64;
+
+inline size_t padTo64(size_t bytes) { return (bytes + ARROW_ALIGNMENT - 1) / ARROW_ALIGNMENT * ARROW_ALIGNMENT; }
+
+class AlignedBuffer
+{
+    uint8_t* data = nullptr;
+    size_t capacity = 0;
+
+    static uint8_t* allocate(size_t bytes)
+    {
+#ifdef _MSC_VER
+        return static_cast<uint8_t*>(_aligned_malloc(bytes, ARROW_ALIGNMENT));
+#else
+        return static_cast<uint8_t*>(std::aligned_alloc(ARROW_ALIGNMENT, bytes));
+#endif
+    }
+
+    static void release(uint8_t* p)
+    {
+#ifdef _MSC_VER
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+
+public:
+    AlignedBuffer() = default;
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+    ~AlignedBuffer() { release(data); }
+
+    // grows at least 2x, padding bytes are zeroed, Arrow readers may read (but never use) them
+    void resize(size_t bytes)
+    {
+        size_t padded = padTo64(std::max<size_t>(bytes, 1));
+        if (padded <= capacity) return;
+        padded = std::max(padded, capacity * 2);
+        uint8_t* grown = allocate(padded);
+        if (data) std::memcpy(grown, data, capacity);
+        std::memset(grown + capacity, 0, padded - capacity);
+        release(data);
+        data = grown;
+        capacity = padded;
+    }
+
+    template<typename T> T* as() { return reinterpret_cast<T*>(data); }
+    template<typename T> const T* as() const { return reinterpret_cast<const T*>(data); }
+    bool empty() const { return data == nullptr; }
+};
+
+
+// ---------- SoA table in Arrow layout ----------
+
+enum Column { X, Y, Z, MASS, LABEL, COLUMN_COUNT };
+const char* columnNames[COLUMN_COUNT] = { "x", "y", "z", "mass", "label" };
+
+struct ParticleColumns
+{
+    size_t length = 0;
+    AlignedBuffer values[4];            // x, y, z, mass as float32
+    AlignedBuffer validity[COLUMN_COUNT]; // empty = no nulls in this column
+    int64_t nullCount[COLUMN_COUNT] = {};
+    AlignedBuffer labelOffsets;         // int32, length + 1 entries
+    AlignedBuffer labelData;
+    size_t labelBytes = 0;
+};
+
+class ArrowParticleTable
+{
+    std::shared_ptr<ParticleColumns> columns = std::make_shared<ParticleColumns>();
+
+public:
+    ArrowParticleTable(size_t n)
+    {
+        columns->length = n;
+        for (auto& v : columns->values) v.resize(n * sizeof(float));
+        columns->labelOffsets.resize((n + 1) * sizeof(int32_t));
+    }
+
+    float* column(Column c) { return columns->values[c].as<float>(); }
+    size_t size() const { return columns->length; }
+
+    // labels have to be appended in row order, Arrow strings are one contiguous byte buffer
+    void setLabel(size_t row, const std::string& label)
+    {
+        int32_t* offsets = columns->labelOffsets.as<int32_t>();
+        offsets[row] = (int32_t)columns->labelBytes;
+        columns->labelData.resize(columns->labelBytes + label.size());
+        std::memcpy(columns->labelData.as<char>() + columns->labelBytes, label.data(), label.size());
+        columns->labelBytes += label.size();
+        offsets[row + 1] = (int32_t)columns->labelBytes;
+    }
+
+    void setNull(Column c, size_t row)
+    {
+        AlignedBuffer& bitmap = columns->validity[c];
+        size_t bytes = (columns->length + 7) / 8;
+        if (bitmap.empty())
+        {
+            bitmap.resize(bytes);
+            std::memset(bitmap.as<uint8_t>(), 0xff, bytes); // everything valid until told otherwise
+        }
+        uint8_t& byte = bitmap.as<uint8_t>()[row / 8];
+        if (byte & (1u << (row % 8))) columns->nullCount[c]++;
+        byte &= uint8_t(~(1u << (row % 8)));
+    }
+
+    void exportTo(ArrowSchema* schema, ArrowArray* array) const;
+};
+
+
+// ---------- export ----------
+
+/*/
+Exported structs own a small private block: the parent owns the child structs, every child owns its buffer pointer
+array and a shared_ptr to the columns. The consumer calls release() when it is done, that drops the shared_ptr, so the
+columns stay alive even if our table is destroyed first. No data is copied.
+A consumer may move a child out and release the parent on its own (the C Data Interface allows that), so a child
+must not point into the parent's block.
+*/
+struct ExportedArray
+{
+    ArrowArray children[COLUMN_COUNT];
+    ArrowArray* childPointers[COLUMN_COUNT];
+    const void* parentBuffers[1] = { nullptr };
+};
+
+struct ExportedChild
+{
+    std::shared_ptr<ParticleColumns> keepAlive;
+    const void* buffers[3];
+};
+
+struct ExportedSchema
+{
+    ArrowSchema children[COLUMN_COUNT];
+    ArrowSchema* childPointers[COLUMN_COUNT];
+};
+
+void releaseChildArray(ArrowArray* array)
+{
+    delete static_cast<ExportedChild*>(array->private_data);
+    array->release = nullptr;
+}
+
+void releaseChildSchema(ArrowSchema* schema) { schema->release = nullptr; }
+
+void releaseArray(ArrowArray* array)
+{
+    for (int64_t c = 0; c < array->n_children; c++)
+        if (array->children[c]->release) array->children[c]->release(array->children[c]);
+    delete static_cast<ExportedArray*>(array->private_data);
+    array->release = nullptr;
+}
+
+void releaseSchema(ArrowSchema* schema)
+{
+    for (int64_t c = 0; c < schema->n_children; c++)
+        if (schema->children[c]->release) schema->children[c]->release(schema->children[c]);
+    delete static_cast<ExportedSchema*>(schema->private_data);
+    schema->release = nullptr;
+}
+
+void ArrowParticleTable::exportTo(ArrowSchema* schema, ArrowArray* array) const
+{
+    auto* s = new ExportedSchema;
+    for (int c = 0; c < COLUMN_COUNT; c++)
+    {
+        s->children[c] = { c == LABEL ? "u" : "f", columnNames[c], nullptr, ARROW_FLAG_NULLABLE, 0, nullptr, nullptr, releaseChildSchema, nullptr };
+        s->childPointers[c] = &s->children[c];
+    }
+    *schema = { "+s", "particles", nullptr, 0, COLUMN_COUNT, s->childPointers, nullptr, releaseSchema, s };
+
+    auto* a = new ExportedArray;
+    const ParticleColumns& cols = *columns;
+    for (int c = 0; c < COLUMN_COUNT; c++)
+    {
+        auto* child = new ExportedChild{ columns, {} };
+        child->buffers[0] = cols.validity[c].empty() ? nullptr : cols.validity[c].as<uint8_t>();
+        int64_t buffers = 2;
+        if (c == LABEL)
+        {
+            child->buffers[1] = cols.labelOffsets.as<int32_t>();
+            child->buffers[2] = cols.labelData.empty() ? cols.labelOffsets.as<char>() : cols.labelData.as<char>(); // never null
+            buffers = 3;
+        }
+        else child->buffers[1] = cols.values[c].as<float>();
+        a->children[c] = { (int64_t)cols.length, cols.nullCount[c], 0, buffers, 0, child->buffers, nullptr, nullptr, releaseChildArray, child };
+        a->childPointers[c] = &a->children[c];
+    }
+    *array = { (int64_t)cols.length, 0, 0, 1, COLUMN_COUNT, a->parentBuffers, a->childPointers, nullptr, releaseArray, a };
+}
+
+
+// ---------- import ----------
+
+/*/
+Import takes ownership of a struct array coming from any producer (moves it, the source is marked released),
+checks the formats and hands out plain pointers to the buffers, again without copying.
+*/
+class ImportedParticles
+{
+    ArrowArray array{};
+    ArrowSchema schema{};
+
+public:
+    const float* values[4] = {};
+    const uint8_t* validity[COLUMN_COUNT] = {};
+    const int32_t* labelOffsets = nullptr;
+    const char* labelData = nullptr;
+    size_t length = 0;
+    bool ok = false;
+    bool aligned = true;
+
+    ImportedParticles(ArrowSchema* s, ArrowArray* a)
+    {
+        schema = *s, array = *a;
+        s->release = nullptr, a->release = nullptr;
+        if (!schema.format || std::string(schema.format) != "+s" || schema.n_children != COLUMN_COUNT || array.n_children != COLUMN_COUNT) return;
+        for (int c = 0; c < COLUMN_COUNT; c++)
+        {
+            const char* expected = c == LABEL ? "u" : "f";
+            const ArrowSchema* childSchema = schema.children[c];
+            const ArrowArray* child = array.children[c];
+            if (!childSchema->format || std::string(childSchema->format) != expected) return;
+            // we read buffers[1] (and buffers[2] for strings) below, so the producer must really have them
+            if (child->n_buffers != (c == LABEL ? 3 : 2) || child->offset != 0 || child->length != array.length) return;
+            for (int64_t b = 1; b < child->n_buffers; b++)
+                if (!child->buffers[b]) return;
+            validity[c] = static_cast<const uint8_t*>(child->buffers[0]);
+            for (int64_t b = 1; b < child->n_buffers; b++)
+                aligned &= reinterpret_cast<uintptr_t>(child->buffers[b]) % ARROW_ALIGNMENT == 0;
+            if (c == LABEL)
+            {
+                labelOffsets = static_cast<const int32_t*>(child->buffers[1]);
+                labelData = static_cast<const char*>(child->buffers[2]);
+            }
+            else values[c] = static_cast<const float*>(child->buffers[1]);
+        }
+        length = (size_t)array.length;
+        ok = true;
+    }
+
+    ~ImportedParticles()
+    {
+        if (array.release) array.release(&array);
+        if (schema.release) schema.release(&schema);
+    }
+
+    bool isValid(Column c, size_t row) const { return !validity[c] || (validity[c][row / 8] >> (row % 8) & 1); }
+    std::string label(size_t row) const { return std::string(labelData + labelOffsets[row], labelOffsets[row + 1] - labelOffsets[row]); }
+};
+
+
+// baseline: what we do without a shared layout, copy every column into the consumer's own buffers
+struct CopiedParticles
+{
+    std::vector<float> values[4];
+    std::vector<int32_t> labelOffsets;
+    std::vector<char> labelData;
+};
+
+CopiedParticles copyOut(ArrowParticleTable& table, const std::vector<std::string>& labels)
+{
+    CopiedParticles copy;
+    for (int c = 0; c < 4; c++) copy.values[c].assign(table.column(Column(c)), table.column(Column(c)) + table.size());
+    copy.labelOffsets.reserve(table.size() + 1);
+    copy.labelOffsets.push_back(0);
+    for (auto& label : labels)
+    {
+        copy.labelData.insert(copy.labelData.end(), label.begin(), label.end());
+        copy.labelOffsets.push_back((int32_t)copy.labelData.size());
+    }
+    return copy;
+}
+
+
+int main()
+{
+    const size_t N = 5'000'000;
+    const char* species[] = { "e-", "e+", "p", "n", "gamma", "mu-" };
+
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    std::uniform_int_distribution<int> pick(0, 5);
+
+    ArrowParticleTable table(N);
+    std::vector<std::string> labels(N);
+    for (size_t i = 0; i < N; i++)
+    {
+        for (int c = 0; c < 4; c++) table.column(Column(c))[i] = dist(rng);
+        labels[i] = species[pick(rng)];
+        table.setLabel(i, labels[i]);
+        if (i % 1000 == 0) table.setNull(MASS, i); // some missing masses
+    }
+
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "Arrow C Data Interface export/import of " << N << " particles (4 float columns + 1 string column)\n\n";
+
+    auto start = Clock::now();
+    ArrowSchema schema;
+    ArrowArray array;
+    table.exportTo(&schema, &array);
+    std::chrono::duration<double, std::milli> exportTime = Clock::now() - start;
+
+    start = Clock::now();
+    ImportedParticles imported(&schema, &array);
+    std::chrono::duration<double, std::milli> importTime = Clock::now() - start;
+
+    start = Clock::now();
+    CopiedParticles copy = copyOut(table, labels);
+    std::chrono::duration<double, std::milli> copyTime = Clock::now() - start;
+
+    if (!imported.ok) { std::cerr << "import failed\n"; return 1; }
+
+    // same query on the imported view and on the copy, x > 0 -> sum mass, skipping null masses
+    double viewSum = 0, copySum = 0;
+    size_t nulls = 0;
+    for (size_t i = 0; i < imported.length; i++)
+    {
+        if (!imported.isValid(MASS, i)) { nulls++; continue; }
+        if (imported.values[X][i] > 0.0f) viewSum += imported.values[MASS][i];
+        if (copy.values[X][i] > 0.0f) copySum += copy.values[MASS][i];
+    }
+
+    std::cout << "export (zero-copy):        " << exportTime.count() << " ms\n";
+    std::cout << "import (zero-copy):        " << importTime.count() << " ms\n";
+    std::cout << "copy into separate buffer: " << copyTime.count() << " ms\n";
+    std::cout << "buffers 64-byte aligned:   " << (imported.aligned ? "yes" : "no") << "\n";
+    std::cout << "null masses: " << nulls << ", label of row 0: " << imported.label(0)
+        << ", sums match: " << (viewSum == copySum ? "yes" : "no") << "\n";
+
+    // a consumer may move one child out and release the parent, the child still owns its buffers
+    ArrowArray movedX;
+    {
+        ArrowParticleTable small(4);
+        for (size_t i = 0; i < 4; i++) small.column(X)[i] = float(i);
+        ArrowSchema smallSchema;
+        ArrowArray smallArray;
+        small.exportTo(&smallSchema, &smallArray);
+        movedX = *smallArray.children[X];
+        smallArray.children[X]->release = nullptr; // moved
+        smallArray.release(&smallArray);
+        smallSchema.release(&smallSchema);
+    } // table gone too
+    const float* movedValues = static_cast<const float*>(movedX.buffers[1]);
+    std::cout << "moved child outlives its parent: " << (movedValues[3] == 3.0f ? "yes" : "no") << "\n";
+    movedX.release(&movedX);
+    return 0;
+}
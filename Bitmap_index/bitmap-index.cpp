@@ -0,0 +1,230 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+A range filter like a < x < b over a float column has to read all 4 bytes of every value, even if it selects 0.1% of rows.
+A binned bitmap index splits the value range into BINS bins with the same number of rows each (equi-depth, so skewed data
+still gets useful bins) and keeps one bitmap per bin. We store them range-encoded: bitmap i has a bit for every row whose
+value is in bin 0..i, so "all rows in bins lo+1 .. hi-1" is just R[hi-1] AND NOT R[lo], two bitmaps, any range width.
+Only rows in the two boundary bins can go either way, for those (and only those) we read the raw x values.
+Everything is combined word-at-a-time, 64 rows per step, and words with no selected rows are skipped.
+
+We compare against a plain branchless scan and against zone maps (min/max per block of rows), which only help when
+the data is clustered, so the benchmark runs on a random column and on a clustered one.
+*/
+
+#ifdef _MSC_VER
+#include <intrin.h>
+inline int countTrailingZeros(uint64_t v) { unsigned long i; _BitScanForward64(&i, v); return (int)i; }
+inline int popCount(uint64_t v) { return (int)__popcnt64(v); }
+#else
+inline int countTrailingZeros(uint64_t v) { return __builtin_ctzll(v); }
+inline int popCount(uint64_t v) { return __builtin_popcountll(v); }
+#endif
+
+constexpr size_t BINS = 32;
+constexpr size_t ZONE = 1024; // rows per zone map block
+
+struct QueryResult
+{
+    size_t count = 0;
+    double sum = 0;
+};
+
+class BinnedBitmapIndex
+{
+    std::vector<float> bounds;              // BINS - 1 upper bounds, bin j holds bounds[j-1] < x <= bounds[j]
+    std::vector<std::vector<uint64_t>> ranges; // range-encoded: ranges[j] = rows with bin <= j
+    size_t words;
+
+    size_t binOf(float v) const { return std::lower_bound(bounds.begin(), bounds.end(), v) - bounds.begin(); }
+
+public:
+    BinnedBitmapIndex(const std::vector<float>& x)
+    {
+        size_t n = x.size();
+        words = (n + 63) / 64;
+
+        // equi-depth bounds from a sorted sample
+        std::vector<float> sample;
+        size_t step = std::max<size_t>(1, n / 65536);
+        for (size_t i = 0; i < n; i += step) sample.push_back(x[i]);
+        std::sort(sample.begin(), sample.end());
+        for (size_t j = 1; j < BINS; j++) bounds.push_back(sample[j * sample.size() / BINS]);
+
+        std::vector<std::vector<uint64_t>> bins(BINS, std::vector<uint64_t>(words, 0));
+        for (size_t i = 0; i < n; i++) bins[binOf(x[i])][i / 64] |= 1ull << (i % 64);
+        ranges.assign(BINS, std::vector<uint64_t>(words, 0));
+        for (size_t j = 0; j < BINS; j++)
+            for (size_t w = 0; w < words; w++) ranges[j][w] = bins[j][w] | (j ? ranges[j - 1][w] : 0);
+    }
+
+    size_t bytes() const { return BINS * words * sizeof(uint64_t); }
+
+    // count and sum of mass for rows with a < x < b
+    QueryResult query(const std::vector<float>& x, const std::vector<float>& mass, float a, float b) const
+    {
+        QueryResult r;
+        if (!(a < b)) return r;
+        size_t lo = binOf(a), hi = binOf(b);
+        const uint64_t* rHiMinus1 = hi > lo + 1 ? ranges[hi - 1].data() : nullptr;
+        const uint64_t* rLo = ranges[lo].data();
+        const uint64_t* rLoMinus1 = lo ? ranges[lo - 1].data() : nullptr;
+        const uint64_t* rHi = ranges[hi].data();
+        const uint64_t* rHiPrev = hi ? ranges[hi - 1].data() : nullptr;
+
+        for (size_t w = 0; w < words; w++)
+        {
+            uint64_t inside = rHiMinus1 ? rHiMinus1[w] & ~rLo[w] : 0;
+            uint64_t boundary = (rLo[w] & ~(rLoMinus1 ? rLoMinus1[w] : 0)) | (rHi[w] & ~(rHiPrev ? rHiPrev[w] : 0));
+            boundary &= ~inside;
+            while (boundary) // only these rows need the raw value
+            {
+                int bit = countTrailingZeros(boundary);
+                boundary &= boundary - 1;
+                float v = x[w * 64 + bit];
+                if (v > a && v < b) inside |= 1ull << bit;
+            }
+            r.count += popCount(inside);
+            while (inside)
+            {
+                int bit = countTrailingZeros(inside);
+                inside &= inside - 1;
+                r.sum += mass[w * 64 + bit];
+            }
+        }
+        return r;
+    }
+};
+
+struct ZoneMap
+{
+    std::vector<float> minX, maxX;
+
+    ZoneMap(const std::vector<float>& x)
+    {
+        for (size_t begin = 0; begin < x.size(); begin += ZONE)
+        {
+            auto range = std::minmax_element(x.begin() + begin, x.begin() + std::min(x.size(), begin + ZONE));
+            minX.push_back(*range.first), maxX.push_back(*range.second);
+        }
+    }
+
+    QueryResult query(const std::vector<float>& x, const std::vector<float>& mass, float a, float b) const
+    {
+        QueryResult r;
+        for (size_t z = 0; z < minX.size(); z++)
+        {
+            if (maxX[z] <= a || minX[z] >= b) continue; // whole block out
+            size_t begin = z * ZONE, end = std::min(x.size(), begin + ZONE);
+            if (minX[z] > a && maxX[z] < b) // whole block in, no need to look at x
+            {
+                for (size_t i = begin; i < end; i++) r.sum += mass[i];
+                r.count += end - begin;
+                continue;
+            }
+            for (size_t i = begin; i < end; i++)
+                if (x[i] > a && x[i] < b) r.sum += mass[i], r.count++;
+        }
+        return r;
+    }
+};
+
+// branchless so the compiler can vectorize it (-O3), this is the baseline every index has to beat
+QueryResult plainScan(const std::vector<float>& x, const std::vector<float>& mass, float a, float b)
+{
+    QueryResult r;
+    size_t count = 0;
+    double sum = 0;
+    for (size_t i = 0; i < x.size(); i++)
+    {
+        bool hit = x[i] > a && x[i] < b;
+        count += hit;
+        sum += hit ? mass[i] : 0.0f;
+    }
+    r.count = count, r.sum = sum;
+    return r;
+}
+
+template<typename F>
+double bestOf(F f, int repeats = 5)
+{
+    double best = 1e300;
+    for (int r = 0; r < repeats; r++)
+    {
+        auto start = Clock::now();
+        volatile size_t sink = f().count;
+        (void)sink;
+        std::chrono::duration<double, std::milli> duration = Clock::now() - start;
+        best = std::min(best, duration.count());
+    }
+    return best;
+}
+
+void runSweep(const char* title, const std::vector<float>& x, const std::vector<float>& mass)
+{
+    auto buildStart = Clock::now();
+    BinnedBitmapIndex index(x);
+    std::chrono::duration<double, std::milli> buildTime = Clock::now() - buildStart;
+    ZoneMap zones(x);
+
+    std::vector<float> sorted = x;
+    std::sort(sorted.begin(), sorted.end());
+
+    std::cout << "== " << title << " == (index " << index.bytes() / (1024 * 1024) << " MB, built in " << buildTime.count() << " ms)\n";
+    std::cout << std::setw(12) << "selectivity"
+        << std::setw(14) << "scan ms"
+        << std::setw(14) << "zone map ms"
+        << std::setw(14) << "bitmap ms"
+        << "\n";
+    for (double selectivity : { 0.001, 0.01, 0.1, 0.5, 0.9 })
+    {
+        // a range in the middle of the distribution that selects the wanted fraction of rows
+        size_t from = size_t((0.5 - selectivity / 2) * (sorted.size() - 1));
+        size_t to = size_t((0.5 + selectivity / 2) * (sorted.size() - 1));
+        float a = sorted[from], b = sorted[to];
+
+        QueryResult expected = plainScan(x, mass, a, b);
+        QueryResult viaIndex = index.query(x, mass, a, b);
+        QueryResult viaZones = zones.query(x, mass, a, b);
+        if (viaIndex.count != expected.count || viaZones.count != expected.count)
+            std::cout << "  warning: count mismatch " << expected.count << " " << viaZones.count << " " << viaIndex.count << "\n";
+
+        std::cout << std::setw(11) << selectivity * 100 << "%"
+            << std::setw(14) << bestOf([&] { return plainScan(x, mass, a, b); })
+            << std::setw(14) << bestOf([&] { return zones.query(x, mass, a, b); })
+            << std::setw(14) << bestOf([&] { return index.query(x, mass, a, b); })
+            << "\n";
+    }
+    std::cout << "\n";
+}
+
+int main()
+{
+    const size_t N = 4'000'000;
+
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    std::normal_distribution<float> noise(0.f, 20.f);
+    std::vector<float> randomX(N), clusteredX(N), mass(N);
+    for (size_t i = 0; i < N; i++)
+    {
+        randomX[i] = dist(rng);
+        clusteredX[i] = -1000.f + 2000.f * float(i) / float(N) + noise(rng); // e.g. particles appended in x order
+        mass[i] = dist(rng);
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Range predicate a < x < b, sum mass (" << N << " rows, " << BINS << " equi-depth bins)\n\n";
+    runSweep("random x", randomX, mass);
+    runSweep("clustered x", clusteredX, mass);
+    return 0;
+}
@@ -0,0 +1,403 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+When a dataset is bigger than RAM, ChunkedVector and the SoA columns can't just new[] every chunk.
+BufferPool owns a fixed number of page frames (the memory budget). Chunks live in pages, and a page
+is either resident in a frame or spilled to a local file:
+- pin(page) makes it resident (reads it back on a miss) and keeps it there until unpin(page)
+- eviction is CLOCK: every frame has a referenced bit set on pin, the hand skips pinned frames, clears set bits,
+  and takes the first frame with the bit already cleared. Dirty victims are written to the spill file first.
+- prefetch(page) is a hint: it reserves a frame and hands the read to a background I/O thread, so a sequential scan
+  can ask for chunk c + depth while it works on chunk c. A pin on a page that is still loading just waits for it.
+PagedVector is a ChunkedVector on top of the pool (chunk = page), and ParticlesPaged has SoA columns of PagedVectors
+that share one pool.
+
+The spill file is a normal tmpfile, so on a machine with free RAM the OS page cache will serve the "disk" reads.
+The numbers then show what the pool itself costs (lookups, copies, syscalls), a real SSD adds its latency on top.
+*/
+
+class BufferPool
+{
+public:
+    static constexpr size_t PAGE_BYTES = 64 * 1024;
+    static constexpr size_t NONE = SIZE_MAX;
+
+private:
+    struct FrameInfo
+    {
+        size_t page = NONE;
+        int pins = 0;
+        bool referenced = false;
+        bool dirty = false;
+        bool loading = false; // read in flight, frame can't be evicted or used yet
+    };
+
+    size_t frameCount;
+    std::unique_ptr<uint8_t[]> memory;
+    std::vector<FrameInfo> frames;
+    std::vector<size_t> frameOf; // page -> frame, NONE if spilled
+    std::vector<bool> onDisk;    // page has a copy in the spill file
+    size_t hand = 0;
+
+    std::FILE* spill;
+    std::mutex ioMutex; // fseek + fread/fwrite has to be one step
+
+    std::mutex mutex;
+    std::condition_variable changed; // a pin was released or a load finished
+
+    std::deque<std::pair<size_t, size_t>> readQueue; // (page, frame) for the I/O thread
+    std::condition_variable readQueued;
+    bool stopping = false;
+    std::thread ioThread;
+
+public:
+    size_t misses = 0, writeBacks = 0, prefetches = 0;
+
+private:
+    uint8_t* frameData(size_t frame) { return memory.get() + frame * PAGE_BYTES; }
+
+    void readPage(size_t page, size_t frame)
+    {
+        std::lock_guard<std::mutex> io(ioMutex);
+        std::fseek(spill, long(page * PAGE_BYTES), SEEK_SET);
+        if (std::fread(frameData(frame), 1, PAGE_BYTES, spill) != PAGE_BYTES) std::memset(frameData(frame), 0, PAGE_BYTES);
+    }
+
+    void writePage(size_t page, size_t frame)
+    {
+        std::lock_guard<std::mutex> io(ioMutex);
+        std::fseek(spill, long(page * PAGE_BYTES), SEEK_SET);
+        std::fwrite(frameData(frame), 1, PAGE_BYTES, spill);
+    }
+
+    // CLOCK, returns a free frame (written back if needed) or NONE if wait is false and everything is pinned
+    size_t findVictim(std::unique_lock<std::mutex>& lock, bool wait)
+    {
+        while (true)
+        {
+            for (size_t step = 0; step < 2 * frameCount; step++)
+            {
+                size_t frame = hand;
+                hand = (hand + 1) % frameCount;
+                FrameInfo& f = frames[frame];
+                if (f.page == NONE) return frame;
+                if (f.pins > 0 || f.loading) continue;
+                if (f.referenced) { f.referenced = false; continue; }
+                if (f.dirty)
+                {
+                    writePage(f.page, frame); // under the pool lock, keeps the bookkeeping simple
+                    onDisk[f.page] = true;
+                    writeBacks++;
+                }
+                frameOf[f.page] = NONE;
+                f = FrameInfo();
+                return frame;
+            }
+            if (!wait) return NONE;
+            changed.wait(lock);
+        }
+    }
+
+    void ioLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            readQueued.wait(lock, [&] { return stopping || !readQueue.empty(); });
+            if (readQueue.empty()) return;
+            auto request = readQueue.front();
+            readQueue.pop_front();
+            lock.unlock();
+            readPage(request.first, request.second);
+            lock.lock();
+            frames[request.second].loading = false;
+            changed.notify_all();
+        }
+    }
+
+public:
+    BufferPool(size_t budgetBytes)
+        : frameCount(std::max<size_t>(8, budgetBytes / PAGE_BYTES)),
+          memory(new uint8_t[frameCount * PAGE_BYTES]),
+          frames(frameCount),
+          spill(std::tmpfile())
+    {
+        if (!spill) { std::cerr << "can't create spill file\n"; std::exit(1); }
+        ioThread = std::thread([this] { ioLoop(); });
+    }
+
+    ~BufferPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        readQueued.notify_all();
+        ioThread.join();
+        std::fclose(spill);
+    }
+
+    size_t frames_count() const { return frameCount; }
+
+    // new zeroed page, returned pinned and dirty
+    size_t newPage(uint8_t*& data)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        size_t page = frameOf.size();
+        frameOf.push_back(NONE);
+        onDisk.push_back(false);
+        size_t frame = findVictim(lock, true);
+        frames[frame] = { page, 1, true, true, false };
+        frameOf[page] = frame;
+        data = frameData(frame);
+        std::memset(data, 0, PAGE_BYTES);
+        return page;
+    }
+
+    uint8_t* pin(size_t page)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        size_t frame = frameOf[page];
+        if (frame != NONE)
+        {
+            frames[frame].pins++;
+            frames[frame].referenced = true;
+            changed.wait(lock, [&] { return !frames[frame].loading; }); // prefetched, read still in flight
+            return frameData(frame);
+        }
+        misses++;
+        frame = findVictim(lock, true);
+        frames[frame] = { page, 1, true, false, true };
+        frameOf[page] = frame;
+        bool stored = onDisk[page]; // never written back yet = still all zeros
+        lock.unlock();
+        if (stored) readPage(page, frame);
+        lock.lock();
+        frames[frame].loading = false;
+        changed.notify_all();
+        return frameData(frame);
+    }
+
+    void unpin(size_t page, bool dirty)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        FrameInfo& f = frames[frameOf[page]];
+        f.dirty |= dirty;
+        if (--f.pins == 0) changed.notify_all();
+    }
+
+    // hint, does nothing if the page is resident or every frame is pinned
+    void prefetch(size_t page)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (page >= frameOf.size() || frameOf[page] != NONE || !onDisk[page]) return;
+        size_t frame = findVictim(lock, false);
+        if (frame == NONE) return;
+        frames[frame] = { page, 0, true, false, true };
+        frameOf[page] = frame;
+        readQueue.push_back({ page, frame });
+        prefetches++;
+        readQueued.notify_one();
+    }
+};
+
+
+// ChunkedVector on top of the pool, every chunk is one page
+template<typename T>
+class PagedVector
+{
+    static constexpr size_t PER_PAGE = BufferPool::PAGE_BYTES / sizeof(T);
+
+    BufferPool& pool;
+    std::vector<size_t> pages; // chunk directory
+    size_t size = 0;
+    T* tail = nullptr;         // the tail page stays pinned while we append
+
+    size_t cachedChunk = BufferPool::NONE; // last chunk read(), kept pinned
+    const T* cachedData = nullptr;
+
+public:
+    PagedVector(BufferPool& pool) : pool(pool) {}
+    ~PagedVector() { finish(); release(); }
+
+    void push_back(const T& value)
+    {
+        if (size % PER_PAGE == 0)
+        {
+            if (tail) pool.unpin(pages.back(), true);
+            uint8_t* data;
+            pages.push_back(pool.newPage(data));
+            tail = reinterpret_cast<T*>(data);
+        }
+        tail[size % PER_PAGE] = value;
+        size++;
+    }
+
+    // done appending, unpins the tail page so it can be spilled too
+    void finish()
+    {
+        if (tail) pool.unpin(pages.back(), true);
+        tail = nullptr;
+    }
+
+    T read(size_t index)
+    {
+        size_t chunk = index / PER_PAGE;
+        if (chunk != cachedChunk)
+        {
+            release();
+            cachedData = reinterpret_cast<const T*>(pool.pin(pages[chunk]));
+            cachedChunk = chunk;
+        }
+        return cachedData[index % PER_PAGE];
+    }
+
+    void release()
+    {
+        if (cachedChunk != BufferPool::NONE) pool.unpin(pages[cachedChunk], false);
+        cachedChunk = BufferPool::NONE;
+    }
+
+    size_t get_size() const { return size; }
+    size_t chunk_count() const { return pages.size(); }
+    size_t chunk_size(size_t chunk) const { return std::min(PER_PAGE, size - chunk * PER_PAGE); }
+
+    const T* pinChunk(size_t chunk) { return reinterpret_cast<const T*>(pool.pin(pages[chunk])); }
+    void unpinChunk(size_t chunk) { pool.unpin(pages[chunk], false); }
+    void prefetchChunk(size_t chunk) { if (chunk < pages.size()) pool.prefetch(pages[chunk]); }
+};
+
+struct ParticlesPaged
+{
+    PagedVector<float> x, y, z, mass;
+    ParticlesPaged(BufferPool& pool) : x(pool), y(pool), z(pool), mass(pool) {}
+
+    // sum mass where x > 0, chunk by chunk, the next prefetchDepth chunks of both columns are requested ahead
+    double massWhereXPositive(size_t prefetchDepth)
+    {
+        double sum = 0;
+        for (size_t c = 0; c < x.chunk_count(); c++)
+        {
+            if (prefetchDepth)
+            {
+                size_t ahead = c + prefetchDepth;
+                if (c == 0)
+                    for (size_t d = 1; d < prefetchDepth; d++) x.prefetchChunk(d), mass.prefetchChunk(d);
+                x.prefetchChunk(ahead), mass.prefetchChunk(ahead);
+            }
+            const float* xs = x.pinChunk(c);
+            const float* ms = mass.pinChunk(c);
+            float partial = 0;
+            for (size_t i = 0; i < x.chunk_size(c); i++) partial += xs[i] > 0.0f ? ms[i] : 0.0f;
+            sum += partial;
+            x.unpinChunk(c), mass.unpinChunk(c);
+        }
+        return sum;
+    }
+};
+
+
+int main()
+{
+    const size_t N = 4'000'000;          // 4 float columns, 64 MB of chunks
+    const size_t RANDOM_READS = 200'000;
+    const size_t PREFETCH_DEPTH = 8;
+    const size_t DATASET_BYTES = 4 * N * sizeof(float);
+
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    std::vector<float> x(N), y(N), z(N), mass(N); // in-memory reference
+    for (size_t i = 0; i < N; i++) x[i] = dist(rng), y[i] = dist(rng), z[i] = dist(rng), mass[i] = dist(rng);
+    std::uniform_int_distribution<size_t> pick(0, N - 1);
+    std::vector<size_t> indices(RANDOM_READS);
+    for (auto& index : indices) index = pick(rng);
+
+    // in-memory baseline
+    auto start = Clock::now();
+    double expected = 0;
+    for (size_t i = 0; i < N; i++) expected += x[i] > 0.0f ? mass[i] : 0.0f;
+    std::chrono::duration<double> memScan = Clock::now() - start;
+    start = Clock::now();
+    double randomExpected = 0;
+    for (size_t index : indices) randomExpected += mass[index];
+    std::chrono::duration<double> memRandom = Clock::now() - start;
+    volatile double sink = expected + randomExpected;
+    (void)sink;
+
+    const double MB = 1024.0 * 1024.0;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Buffer pool with spill file (" << N << " particles, " << DATASET_BYTES / MB << " MB of columns, "
+        << BufferPool::PAGE_BYTES / 1024 << " KB pages)\n";
+    std::cout << "in memory: scan " << 2 * N * sizeof(float) / memScan.count() / MB << " MB/s, random reads "
+        << RANDOM_READS / memRandom.count() / 1e6 << " M/s\n\n";
+    std::cout << std::setw(8) << "ratio"
+        << std::setw(10) << "frames"
+        << std::setw(18) << "scan MB/s"
+        << std::setw(18) << "scan+prefetch"
+        << std::setw(14) << "misses"
+        << std::setw(16) << "random M/s"
+        << std::setw(16) << "random misses"
+        << "\n";
+
+    for (double ratio : { 0.5, 1.0, 2.0, 5.0, 10.0 })
+    {
+        BufferPool pool(size_t(double(DATASET_BYTES) / ratio));
+        ParticlesPaged particles(pool);
+        for (size_t i = 0; i < N; i++)
+        {
+            particles.x.push_back(x[i]), particles.y.push_back(y[i]);
+            particles.z.push_back(z[i]), particles.mass.push_back(mass[i]);
+        }
+        particles.x.finish(), particles.y.finish(), particles.z.finish(), particles.mass.finish();
+
+        particles.massWhereXPositive(0); // warm up, same state for both scans
+        size_t missesBefore = pool.misses;
+        start = Clock::now();
+        double plainSum = particles.massWhereXPositive(0);
+        std::chrono::duration<double> scanTime = Clock::now() - start;
+        size_t scanMisses = pool.misses - missesBefore;
+
+        start = Clock::now();
+        double prefetchSum = particles.massWhereXPositive(PREFETCH_DEPTH);
+        std::chrono::duration<double> prefetchTime = Clock::now() - start;
+
+        missesBefore = pool.misses;
+        start = Clock::now();
+        double randomSum = 0;
+        for (size_t index : indices) randomSum += particles.mass.read(index);
+        std::chrono::duration<double> randomTime = Clock::now() - start;
+        particles.mass.release();
+        size_t randomMisses = pool.misses - missesBefore;
+
+        if (std::abs(plainSum - expected) > 1e-3 * std::abs(expected) || std::abs(prefetchSum - expected) > 1e-3 * std::abs(expected)
+            || std::abs(randomSum - randomExpected) > 1e-3 * std::abs(randomExpected) + 1.0)
+            std::cout << "  warning: results differ from the in-memory columns\n";
+
+        std::cout << std::setw(7) << ratio << "x"
+            << std::setw(10) << pool.frames_count()
+            << std::setw(18) << 2 * N * sizeof(float) / scanTime.count() / MB
+            << std::setw(18) << 2 * N * sizeof(float) / prefetchTime.count() / MB
+            << std::setw(14) << scanMisses
+            << std::setw(16) << RANDOM_READS / randomTime.count() / 1e6
+            << std::setw(16) << randomMisses
+            << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,375 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <iomanip>
+#include <string>
+#include <cstdint>
+#include <bitset>
+#include <algorithm>
+
+/*/
+The AoS/SoA explanation is all about cache lines, but timing alone doesn't show what the cache actually did.
+Here we record every element access the containers make (address + size) and replay that trace through a small
+set-associative cache simulator with several levels and a TLB.
+For every level we get hit rate, and for L1 we also track which bytes of each line were really used before the line got evicted,
+which gives us cache-line utilization and bytes used vs bytes fetched.
+No special hardware or perf counters needed, everything runs in software.
+*/
+
+
+// ---------- access trace ----------
+
+struct Access
+{
+    uintptr_t address;
+    uint32_t size;
+    bool write;
+};
+
+/*/
+Instrumented build: when TRACE_ACCESSES is 1, operator[] and iterators of the containers below push every access into the trace.
+With 0 the record call compiles to nothing, and the containers behave like the normal ones.
+*/
+#ifndef TRACE_ACCESSES
+#define TRACE_ACCESSES 1
+#endif
+
+std::vector<Access> trace;
+
+inline void recordAccess(const void* p, size_t size, bool write = false)
+{
+#if TRACE_ACCESSES
+    trace.push_back({ reinterpret_cast<uintptr_t>(p), static_cast<uint32_t>(size), write });
+#else
+    (void)p; (void)size; (void)write;
+#endif
+}
+
+
+// ---------- instrumented containers ----------
+
+template<typename T>
+class TracedVector
+{
+    std::vector<T> data;
+
+public:
+    TracedVector(size_t n = 0) : data(n) {}
+
+    void push_back(const T& value) { data.push_back(value); recordAccess(&data.back(), sizeof(T), true); }
+
+    const T& operator[](size_t index) const { recordAccess(&data[index], sizeof(T)); return data[index]; }
+
+    // for structs we want to know which field is touched, not the whole struct
+    template<typename F, typename C = T>
+    const F& field(size_t index, F C::* member) const
+    {
+        const F& f = data[index].*member;
+        recordAccess(&f, sizeof(F));
+        return f;
+    }
+
+    T* raw() { return data.data(); } // untraced access, used for initialization
+    size_t size() const { return data.size(); }
+};
+
+template<typename T, size_t CHUNK_SIZE = 64>
+class TracedChunkedVector {
+    std::vector<T*> chunks;
+    size_t size = 0;
+
+public:
+    ~TracedChunkedVector() {
+        for (auto chunk : chunks) delete[] chunk;
+    }
+
+    void push_back(const T& value) {
+        if (size % CHUNK_SIZE == 0)
+            chunks.push_back(new T[CHUNK_SIZE]);
+        chunks[size / CHUNK_SIZE][size % CHUNK_SIZE] = value;
+        size++;
+    }
+
+    const T& operator[](size_t index) const {
+        recordAccess(&chunks[index / CHUNK_SIZE], sizeof(T*)); // the chunk directory lookup is a memory access too
+        const T& value = chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+        recordAccess(&value, sizeof(T));
+        return value;
+    }
+
+    // iterator walks chunk by chunk, so the directory is read once per chunk and not once per element
+    class iterator
+    {
+        const TracedChunkedVector* v;
+        size_t index;
+        const T* current;
+    public:
+        iterator(const TracedChunkedVector* v, size_t index) : v(v), index(index), current(nullptr) {}
+        const T& operator*()
+        {
+            if (index % CHUNK_SIZE == 0 || !current)
+            {
+                recordAccess(&v->chunks[index / CHUNK_SIZE], sizeof(T*));
+                current = v->chunks[index / CHUNK_SIZE];
+            }
+            recordAccess(&current[index % CHUNK_SIZE], sizeof(T));
+            return current[index % CHUNK_SIZE];
+        }
+        iterator& operator++() { index++; return *this; }
+        bool operator!=(const iterator& other) const { return index != other.index; }
+    };
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, size); }
+    size_t get_size() const { return size; }
+};
+
+
+// ---------- cache simulator ----------
+
+struct CacheConfig
+{
+    std::string name;
+    size_t sizeBytes;
+    size_t lineSize; // for a TLB this is the page size
+    size_t ways;
+};
+
+/*/
+One set-associative level with LRU replacement. Each way stores its tag and the last time it was used.
+For utilization we also keep a bitmask of touched bytes for every resident line (up to 256-byte lines).
+*/
+class CacheLevel
+{
+    struct Way
+    {
+        uint64_t tag = 0;
+        uint64_t lastUse = 0;
+        bool valid = false;
+        std::bitset<256> used;
+    };
+
+    CacheConfig config;
+    size_t sets;
+    std::vector<Way> ways; // sets * config.ways
+    uint64_t tick = 0;
+
+public:
+    uint64_t hits = 0, misses = 0;
+    uint64_t usedBytesOfEvicted = 0, evictedLines = 0;
+
+    CacheLevel(const CacheConfig& c) : config(c), sets(c.sizeBytes / (c.lineSize * c.ways)), ways(sets * c.ways) {}
+
+    const CacheConfig& getConfig() const { return config; }
+
+    // returns true on hit, on miss the line is filled (evicting LRU way)
+    bool access(uint64_t address, size_t offset = 0, size_t size = 0)
+    {
+        uint64_t line = address / config.lineSize;
+        size_t set = line % sets;
+        Way* begin = &ways[set * config.ways];
+        Way* victim = begin;
+        tick++;
+        for (Way* w = begin; w != begin + config.ways; w++)
+        {
+            if (w->valid && w->tag == line)
+            {
+                hits++;
+                w->lastUse = tick;
+                markUsed(*w, offset, size);
+                return true;
+            }
+            if (!w->valid || (victim->valid && w->lastUse < victim->lastUse)) victim = w;
+        }
+        misses++;
+        if (victim->valid) retire(*victim);
+        victim->valid = true;
+        victim->tag = line;
+        victim->lastUse = tick;
+        victim->used.reset();
+        markUsed(*victim, offset, size);
+        return false;
+    }
+
+    // at the end of replay, lines still in the cache count towards utilization as well
+    void flush()
+    {
+        for (auto& w : ways)
+            if (w.valid) { retire(w); w.valid = false; }
+    }
+
+    double hitRate() const { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+    double lineUtilization() const { return evictedLines ? double(usedBytesOfEvicted) / double(evictedLines * config.lineSize) : 0.0; }
+
+private:
+    void markUsed(Way& w, size_t offset, size_t size)
+    {
+        for (size_t b = offset; b < offset + size && b < w.used.size(); b++) w.used.set(b);
+    }
+
+    void retire(Way& w)
+    {
+        usedBytesOfEvicted += w.used.count();
+        evictedLines++;
+    }
+};
+
+/*/
+Levels are looked up in order, a miss in level i goes to level i+1, and the line is filled into every level on the way back.
+TLB levels are independent and get one lookup per page touched.
+*/
+class MemorySimulator
+{
+    std::vector<CacheLevel> caches;
+    std::vector<CacheLevel> tlbs;
+
+public:
+    MemorySimulator(const std::vector<CacheConfig>& cacheConfigs, const std::vector<CacheConfig>& tlbConfigs)
+    {
+        for (auto& c : cacheConfigs) caches.emplace_back(c);
+        for (auto& c : tlbConfigs) tlbs.emplace_back(c);
+    }
+
+    void replay(const std::vector<Access>& accesses)
+    {
+        size_t lineSize = caches.front().getConfig().lineSize;
+        for (const Access& a : accesses)
+        {
+            // an access can straddle two lines, we split it
+            uint64_t address = a.address;
+            uint64_t end = a.address + a.size;
+            while (address < end)
+            {
+                uint64_t lineEnd = (address / lineSize + 1) * lineSize;
+                uint64_t chunkEnd = std::min(end, lineEnd);
+                for (auto& tlb : tlbs)
+                    if (tlb.access(address)) break;
+                for (auto& cache : caches)
+                    if (cache.access(address, address % lineSize, chunkEnd - address)) break;
+                address = chunkEnd;
+            }
+        }
+        for (auto& cache : caches) cache.flush();
+    }
+
+    void report(const std::string& title, uint64_t bytesRequested) const
+    {
+        const CacheLevel& l1 = caches.front();
+        const CacheLevel& last = caches.back();
+        size_t lineSize = l1.getConfig().lineSize;
+        std::cout << "== " << title << " ==\n";
+        for (auto& level : caches)
+            std::cout << std::setw(8) << level.getConfig().name << "  hit rate " << std::setw(8) << level.hitRate() * 100 << " %"
+                << "   misses " << level.misses << "\n";
+        for (auto& tlb : tlbs)
+            std::cout << std::setw(8) << tlb.getConfig().name << "  hit rate " << std::setw(8) << tlb.hitRate() * 100 << " %"
+                << "   misses " << tlb.misses << "\n";
+        std::cout << "  bytes requested by program:  " << bytesRequested << "\n";
+        std::cout << "  bytes fetched into L1:       " << l1.misses * lineSize << "\n";
+        std::cout << "  bytes fetched from memory:   " << last.misses * last.getConfig().lineSize << "\n";
+        std::cout << "  L1 cache-line utilization:   " << l1.lineUtilization() * 100 << " %\n\n";
+    }
+};
+
+
+// ---------- workloads ----------
+
+struct ParticleAos
+{
+    float x, y, z;
+    double mass; // same layout as in AoS-SoA benchmark, 4 bytes of padding after z
+};
+
+struct ParticlesSoA
+{
+    TracedVector<float> x, y, z, mass;
+    ParticlesSoA(size_t n) : x(n), y(n), z(n), mass(n) {}
+};
+
+uint64_t requestedBytes(const std::vector<Access>& accesses)
+{
+    uint64_t total = 0;
+    for (auto& a : accesses) total += a.size;
+    return total;
+}
+
+int main()
+{
+    const size_t N = 200'000; // keep it small, the simulator is much slower than real hardware
+
+    // modify these to model a different cpu
+    std::vector<CacheConfig> caches = {
+        { "L1d", 32 * 1024, 64, 8 },
+        { "L2", 1024 * 1024, 64, 16 },
+        { "L3", 8 * 1024 * 1024, 64, 16 },
+    };
+    std::vector<CacheConfig> tlbs = {
+        { "dTLB", 64 * 4096, 4096, 4 },
+        { "STLB", 1536 * 4096, 4096, 12 },
+    };
+
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    std::cout << std::fixed << std::setprecision(2);
+
+    {
+        TracedVector<ParticleAos> particles(N);
+        for (size_t i = 0; i < N; i++) particles.raw()[i] = { dist(rng), dist(rng), dist(rng), dist(rng) };
+        trace.clear();
+        double sum = 0;
+        for (size_t k = 0; k < N; k++)
+            if (particles.field(k, &ParticleAos::x) > 0.0f) sum += particles.field(k, &ParticleAos::mass);
+        MemorySimulator sim(caches, tlbs);
+        sim.replay(trace);
+        sim.report("AoS: if (x > 0) sum += mass", requestedBytes(trace));
+        if (sum == 0) std::cout << "";
+    }
+
+    {
+        ParticlesSoA particles(N);
+        for (size_t i = 0; i < N; i++)
+        {
+            particles.x.raw()[i] = dist(rng);
+            particles.y.raw()[i] = dist(rng);
+            particles.z.raw()[i] = dist(rng);
+            particles.mass.raw()[i] = dist(rng);
+        }
+        trace.clear();
+        double sum = 0;
+        for (size_t k = 0; k < N; k++)
+            if (particles.x[k] > 0.0f) sum += particles.mass[k];
+        MemorySimulator sim(caches, tlbs);
+        sim.replay(trace);
+        sim.report("SoA: if (x > 0) sum += mass", requestedBytes(trace));
+        if (sum == 0) std::cout << "";
+    }
+
+    {
+        TracedChunkedVector<int> v;
+        for (size_t k = 0; k < N; k++) v.push_back((int)k);
+        trace.clear();
+        long long sum = 0;
+        for (int value : v) sum += value;
+        MemorySimulator sim(caches, tlbs);
+        sim.replay(trace);
+        sim.report("ChunkedVector<int>: sequential sum (iterator)", requestedBytes(trace));
+        if (sum == 0) std::cout << "";
+    }
+
+    {
+        TracedChunkedVector<int> v;
+        for (size_t k = 0; k < N; k++) v.push_back((int)k);
+        std::vector<size_t> indices(N);
+        std::uniform_int_distribution<size_t> pick(0, N - 1);
+        for (auto& index : indices) index = pick(rng);
+        trace.clear();
+        long long sum = 0;
+        for (size_t index : indices) sum += v[index];
+        MemorySimulator sim(caches, tlbs);
+        sim.replay(trace);
+        sim.report("ChunkedVector<int>: random reads (operator[])", requestedBytes(trace));
+        if (sum == 0) std::cout << "";
+    }
+
+    return 0;
+}
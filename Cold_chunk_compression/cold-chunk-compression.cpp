@@ -0,0 +1,313 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+#include <cmath>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+In append-heavy ChunkedVectors (event logs, timestamps) only the last few chunks are really used, the rest just takes RAM.
+CompressedChunkedVector compresses chunks that were not touched for a while and decompresses them on access:
+- every directory entry knows its chunk's state: Hot (raw buffer, maybe with a still valid compressed copy) or Cold
+  (compressed bytes only)
+- at most hotBudget chunks are hot, when another one has to be decompressed the least recently used hot chunk goes cold.
+  If it wasn't written since it was decompressed, its compressed copy is still valid and we just free the raw buffer.
+- the tail chunk (the one push_back writes to) is always hot and not counted in the budget
+Codec: delta to the previous value, zigzag, LEB128 varint (the same varint as the trace format in Trace_replay).
+Sorted-ish integer data (timestamps, ids) gets 1 byte per value instead of 4, no dependency needed.
+The last accessed chunk is cached, so sequential access pays the directory lookup once per chunk.
+*/
+
+// ---------- delta + zigzag + varint codec ----------
+
+template<typename T>
+void compressChunk(const T* values, size_t count, std::vector<uint8_t>& out)
+{
+    static_assert(std::is_integral<T>::value, "delta codec is for integer columns");
+    out.clear();
+    int64_t previous = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        int64_t delta = int64_t(values[i]) - previous;
+        previous = int64_t(values[i]);
+        uint64_t zigzag = (uint64_t(delta) << 1) ^ uint64_t(delta >> 63); // small negative deltas stay small
+        while (zigzag >= 0x80)
+        {
+            out.push_back(uint8_t(zigzag) | 0x80);
+            zigzag >>= 7;
+        }
+        out.push_back(uint8_t(zigzag));
+    }
+}
+
+template<typename T>
+void decompressChunk(const std::vector<uint8_t>& in, T* values, size_t count)
+{
+    const uint8_t* p = in.data();
+    int64_t previous = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t zigzag = 0;
+        int shift = 0;
+        uint8_t byte;
+        do
+        {
+            byte = *p++;
+            zigzag |= uint64_t(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        previous += int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1);
+        values[i] = T(previous);
+    }
+}
+
+
+//CHUNKED VECTOR WITH NEW[] (same as in Vector_allocation_benhmarks), the baseline
+template<typename T, size_t CHUNK_SIZE = 64>
+class ChunkedVector {
+    std::vector<T*> chunks;
+    size_t size = 0;
+
+public:
+    ~ChunkedVector() {
+        for (auto chunk : chunks) delete[] chunk;
+    }
+
+    void push_back(const T& value) {
+        if (size % CHUNK_SIZE == 0)
+            chunks.push_back(new T[CHUNK_SIZE]);
+        chunks[size / CHUNK_SIZE][size % CHUNK_SIZE] = value;
+        size++;
+    }
+
+    T& operator[](size_t index) {
+        return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+
+    size_t get_size() const { return size; }
+    size_t bytes() const { return chunks.size() * (CHUNK_SIZE * sizeof(T) + sizeof(T*)); }
+};
+
+
+template<typename T, size_t CHUNK_SIZE = 4096>
+class CompressedChunkedVector
+{
+    enum class State : uint8_t { Hot, Cold };
+
+    struct ChunkEntry
+    {
+        State state = State::Hot;
+        bool dirty = true;              // raw buffer changed since the compressed copy was made (or there is none)
+        uint64_t lastAccess = 0;
+        T* data = nullptr;              // only when hot
+        std::vector<uint8_t> compressed; // only valid when !dirty
+    };
+
+    std::vector<ChunkEntry> directory;
+    std::vector<size_t> hotChunks;      // sealed hot chunks, at most hotBudget of them
+    std::vector<T*> spareBuffers;       // a few raw buffers of chunks that went cold, reused for the next hot chunk
+    size_t hotBudget;
+    size_t size = 0;
+    uint64_t tick = 0;
+
+    size_t lastChunk = SIZE_MAX;        // one-entry lookup cache for sequential access
+    T* lastData = nullptr;
+
+    size_t decompressions = 0, compressions = 0;
+
+    T* rawBuffer()
+    {
+        if (spareBuffers.empty()) return new T[CHUNK_SIZE];
+        T* buffer = spareBuffers.back();
+        spareBuffers.pop_back();
+        return buffer;
+    }
+
+    void makeCold(size_t chunk)
+    {
+        ChunkEntry& e = directory[chunk];
+        if (e.dirty)
+        {
+            compressChunk(e.data, CHUNK_SIZE, e.compressed);
+            e.compressed.shrink_to_fit();
+            e.dirty = false;
+            compressions++;
+        }
+        if (spareBuffers.size() < 4) spareBuffers.push_back(e.data);
+        else delete[] e.data;
+        e.data = nullptr;
+        e.state = State::Cold;
+        if (lastChunk == chunk) lastChunk = SIZE_MAX;
+    }
+
+    // a sealed chunk became hot (or was just sealed), keep the hot set inside the budget
+    void addHot(size_t chunk)
+    {
+        hotChunks.push_back(chunk);
+        if (hotChunks.size() <= hotBudget) return;
+        auto victim = std::min_element(hotChunks.begin(), hotChunks.end(), [&](size_t a, size_t b) {
+            return directory[a].lastAccess < directory[b].lastAccess;
+        });
+        makeCold(*victim);
+        *victim = hotChunks.back();
+        hotChunks.pop_back();
+    }
+
+    T* touch(size_t chunk)
+    {
+        ChunkEntry& e = directory[chunk];
+        e.lastAccess = ++tick;
+        if (e.state == State::Cold)
+        {
+            e.data = rawBuffer();
+            decompressChunk(e.compressed, e.data, CHUNK_SIZE);
+            e.state = State::Hot;
+            decompressions++;
+            addHot(chunk);
+        }
+        lastChunk = chunk, lastData = e.data;
+        return e.data;
+    }
+
+public:
+    CompressedChunkedVector(size_t hotBudget = 16) : hotBudget(std::max<size_t>(1, hotBudget)) {}
+
+    ~CompressedChunkedVector()
+    {
+        for (auto& e : directory) delete[] e.data;
+        for (T* buffer : spareBuffers) delete[] buffer;
+    }
+
+    void push_back(const T& value)
+    {
+        if (size % CHUNK_SIZE == 0)
+        {
+            if (!directory.empty()) addHot(directory.size() - 1); // old tail is sealed, it now counts against the budget
+            directory.emplace_back();
+            directory.back().data = rawBuffer();
+            directory.back().lastAccess = ++tick;
+        }
+        directory.back().data[size % CHUNK_SIZE] = value;
+        size++;
+    }
+
+    // read access, keeps a clean chunk clean so it can go cold without compressing again
+    T read(size_t index)
+    {
+        size_t chunk = index / CHUNK_SIZE;
+        T* data = chunk == lastChunk ? lastData : touch(chunk);
+        return data[index % CHUNK_SIZE];
+    }
+
+    T& operator[](size_t index)
+    {
+        size_t chunk = index / CHUNK_SIZE;
+        T* data = chunk == lastChunk ? lastData : touch(chunk);
+        directory[chunk].dirty = true;
+        return data[index % CHUNK_SIZE];
+    }
+
+    size_t get_size() const { return size; }
+
+    size_t residentBytes() const
+    {
+        size_t bytes = directory.capacity() * sizeof(ChunkEntry) + hotChunks.capacity() * sizeof(size_t);
+        for (auto& e : directory)
+        {
+            if (e.data) bytes += CHUNK_SIZE * sizeof(T);
+            bytes += e.compressed.capacity();
+        }
+        bytes += spareBuffers.size() * CHUNK_SIZE * sizeof(T);
+        return bytes;
+    }
+
+    size_t decompressCount() const { return decompressions; }
+    size_t compressCount() const { return compressions; }
+};
+
+
+// reads that mostly hit the newest data: distance from the tail is exponential with the given mean
+std::vector<size_t> recencySkewedIndices(size_t n, size_t count, double meanDistance, std::mt19937_64& rng)
+{
+    std::exponential_distribution<double> distance(1.0 / meanDistance);
+    std::vector<size_t> indices(count);
+    for (auto& index : indices) index = n - 1 - std::min(n - 1, size_t(distance(rng)));
+    return indices;
+}
+
+template<typename Container>
+double nsPerRead(Container& c, const std::vector<size_t>& indices)
+{
+    auto start = Clock::now();
+    long long sum = 0;
+    for (size_t index : indices) sum += c.read(index);
+    std::chrono::duration<double, std::nano> duration = Clock::now() - start;
+    volatile long long sink = sum;
+    (void)sink;
+    return duration.count() / indices.size();
+}
+
+// adapter so the baseline has the same read() as the compressed vector
+struct PlainChunked
+{
+    ChunkedVector<int> v;
+    int read(size_t index) { return v[index]; }
+};
+
+int main()
+{
+    const size_t N = 25'000'000;
+    const size_t READS = 500'000;
+
+    // event timestamps: increasing with random gaps
+    std::mt19937_64 rng(123);
+    std::uniform_int_distribution<int> gap(0, 50);
+    std::vector<int> timestamps(N);
+    int t = 0;
+    for (auto& ts : timestamps) ts = t += gap(rng);
+
+    PlainChunked plain;
+    for (int ts : timestamps) plain.v.push_back(ts);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Cold chunk compression (" << N << " int timestamps, 4096-value chunks, " << READS << " reads per row)\n";
+    std::cout << "plain ChunkedVector<int>: " << plain.v.bytes() / (1024.0 * 1024.0) << " MB resident\n\n";
+    std::cout << std::setw(16) << "mean distance"
+        << std::setw(12) << "hot chunks"
+        << std::setw(14) << "resident MB"
+        << std::setw(14) << "plain ns"
+        << std::setw(16) << "compressed ns"
+        << std::setw(18) << "decompress/1k"
+        << "\n";
+
+    for (double meanDistance : { 10'000.0, 100'000.0, 1'000'000.0 })
+    {
+        std::vector<size_t> indices = recencySkewedIndices(N, READS, meanDistance, rng);
+        double plainNs = nsPerRead(plain, indices);
+        for (size_t budget : { 4, 16, 64, 256 })
+        {
+            CompressedChunkedVector<int> compressed(budget);
+            for (int ts : timestamps) compressed.push_back(ts);
+            for (size_t k = 0; k < 1000; k++)
+                if (compressed.read(indices[k]) != timestamps[indices[k]]) { std::cout << "  warning: read mismatch\n"; break; }
+
+            size_t before = compressed.decompressCount();
+            double compressedNs = nsPerRead(compressed, indices);
+            size_t decompressions = compressed.decompressCount() - before;
+
+            std::cout << std::setw(16) << size_t(meanDistance)
+                << std::setw(12) << budget
+                << std::setw(14) << compressed.residentBytes() / (1024.0 * 1024.0)
+                << std::setw(14) << plainNs
+                << std::setw(16) << compressedNs
+                << std::setw(18) << 1000.0 * double(decompressions) / double(READS)
+                << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,240 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+Category-like columns (cell ids, type ids) repeat the same few values over and over, and a plain int column spends
+4 bytes on every row anyway. Two encodings, both scanned without decompressing:
+- Dictionary: the distinct values go into a sorted dictionary, every row stores only a small code (1, 2 or 4 bytes,
+  whatever the cardinality needs). A predicate is evaluated once per dictionary entry into a lookup table,
+  the scan then only does table[code] per row.
+- RLE (run-length encoding): consecutive equal values become one (value, end) run. The predicate is evaluated once
+  per run, and a matching run selects a whole contiguous range of the other columns, so summing mass over it
+  is a plain tight loop.
+Which one wins depends on the data: dictionary needs low cardinality, RLE needs long runs (sorted or clustered data).
+*/
+
+// plain column, what we compare against
+struct PlainColumn
+{
+    std::vector<int> values;
+
+    PlainColumn(const std::vector<int>& v) : values(v) {}
+
+    size_t bytes() const { return values.size() * sizeof(int); }
+
+    template<typename Pred>
+    double sumWhere(Pred pred, const std::vector<float>& mass, size_t& count) const
+    {
+        double sum = 0;
+        size_t hits = 0;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            bool hit = pred(values[i]);
+            hits += hit;
+            sum += hit ? mass[i] : 0.0f;
+        }
+        count = hits;
+        return sum;
+    }
+};
+
+template<typename Code>
+class DictionaryColumn
+{
+    std::vector<int> dictionary; // sorted distinct values, code = position
+    std::vector<Code> codes;
+
+public:
+    DictionaryColumn(const std::vector<int>& values)
+    {
+        dictionary = values;
+        std::sort(dictionary.begin(), dictionary.end());
+        dictionary.erase(std::unique(dictionary.begin(), dictionary.end()), dictionary.end());
+        std::unordered_map<int, Code> codeOf;
+        for (size_t c = 0; c < dictionary.size(); c++) codeOf[dictionary[c]] = Code(c);
+        codes.resize(values.size());
+        for (size_t i = 0; i < values.size(); i++) codes[i] = codeOf[values[i]];
+    }
+
+    size_t bytes() const { return codes.size() * sizeof(Code) + dictionary.size() * sizeof(int); }
+    int operator[](size_t i) const { return dictionary[codes[i]]; }
+
+    template<typename Pred>
+    double sumWhere(Pred pred, const std::vector<float>& mass, size_t& count) const
+    {
+        // predicate once per distinct value, float 0/1 so the row loop has no branch and no bool->float conversion
+        std::vector<float> selected(dictionary.size());
+        std::vector<uint8_t> selectedCount(dictionary.size());
+        for (size_t c = 0; c < dictionary.size(); c++) selectedCount[c] = pred(dictionary[c]), selected[c] = selectedCount[c];
+
+        double sum = 0;
+        size_t hits = 0;
+        for (size_t i = 0; i < codes.size(); i++)
+        {
+            hits += selectedCount[codes[i]];
+            sum += selected[codes[i]] * mass[i];
+        }
+        count = hits;
+        return sum;
+    }
+};
+
+class RleColumn
+{
+    std::vector<int> runValues;
+    std::vector<uint32_t> runEnds; // exclusive end row of every run, so a row lookup is a binary search
+
+public:
+    RleColumn(const std::vector<int>& values)
+    {
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            if (runValues.empty() || runValues.back() != values[i]) runValues.push_back(values[i]), runEnds.push_back(0);
+            runEnds.back() = uint32_t(i + 1);
+        }
+    }
+
+    size_t bytes() const { return runValues.size() * (sizeof(int) + sizeof(uint32_t)); }
+    size_t runs() const { return runValues.size(); }
+    int operator[](size_t i) const { return runValues[std::upper_bound(runEnds.begin(), runEnds.end(), uint32_t(i)) - runEnds.begin()]; }
+
+    template<typename Pred>
+    double sumWhere(Pred pred, const std::vector<float>& mass, size_t& count) const
+    {
+        double sum = 0;
+        size_t hits = 0, begin = 0;
+        for (size_t r = 0; r < runValues.size(); r++)
+        {
+            size_t end = runEnds[r];
+            if (pred(runValues[r]))
+            {
+                float runSum = 0; // whole run selected, contiguous loop the compiler can vectorize
+                for (size_t i = begin; i < end; i++) runSum += mass[i];
+                sum += runSum;
+                hits += end - begin;
+            }
+            begin = end;
+        }
+        count = hits;
+        return sum;
+    }
+};
+
+// SoA container with a pluggable encoding for the cell id column
+template<typename CellColumn>
+struct ParticlesSoA
+{
+    std::vector<float> mass;
+    CellColumn cellId;
+
+    ParticlesSoA(const std::vector<float>& mass, const std::vector<int>& cellIds) : mass(mass), cellId(cellIds) {}
+
+    template<typename Pred>
+    double massWhereCell(Pred pred, size_t& count) const { return cellId.sumWhere(pred, mass, count); }
+};
+
+template<typename F>
+double bestOf(F f, int repeats = 5)
+{
+    double best = 1e300;
+    for (int r = 0; r < repeats; r++)
+    {
+        auto start = Clock::now();
+        volatile double sink = f();
+        (void)sink;
+        std::chrono::duration<double, std::milli> duration = Clock::now() - start;
+        best = std::min(best, duration.count());
+    }
+    return best;
+}
+
+// cell ids come in runs of 1 .. 2 * meanRun rows, ids are spread out so the dictionary is not just 0..cardinality-1
+std::vector<int> generateCells(size_t n, size_t cardinality, size_t meanRun, std::mt19937_64& rng)
+{
+    std::uniform_int_distribution<size_t> cell(0, cardinality - 1);
+    std::uniform_int_distribution<size_t> runLength(1, 2 * meanRun - 1);
+    std::vector<int> cells;
+    cells.reserve(n);
+    while (cells.size() < n)
+    {
+        int id = int(cell(rng) * 7919 + 1000);
+        size_t length = std::min(runLength(rng), n - cells.size());
+        cells.insert(cells.end(), length, id);
+    }
+    return cells;
+}
+
+template<typename Code>
+void runCase(size_t cardinality, size_t meanRun, const std::vector<int>& cells, const std::vector<float>& mass)
+{
+    ParticlesSoA<PlainColumn> plain(mass, cells);
+    ParticlesSoA<DictionaryColumn<Code>> dict(mass, cells);
+    ParticlesSoA<RleColumn> rle(mass, cells);
+
+    auto pred = [](int id) { return id % 10 < 3; }; // about 30% of cells
+    size_t plainCount, dictCount, rleCount;
+    double plainSum = plain.massWhereCell(pred, plainCount);
+    double dictSum = dict.massWhereCell(pred, dictCount);
+    double rleSum = rle.massWhereCell(pred, rleCount);
+    if (dictCount != plainCount || rleCount != plainCount
+        || std::abs(dictSum - plainSum) > 1e-3 * std::abs(plainSum) + 1.0 || std::abs(rleSum - plainSum) > 1e-3 * std::abs(plainSum) + 1.0)
+        std::cout << "  warning: results differ " << plainSum << " " << dictSum << " " << rleSum << "\n";
+
+    size_t count;
+    const double MB = 1024.0 * 1024.0;
+    std::cout << std::setw(12) << cardinality
+        << std::setw(10) << meanRun
+        << std::setw(10) << rle.cellId.runs()
+        << std::setw(12) << plain.cellId.bytes() / MB
+        << std::setw(12) << dict.cellId.bytes() / MB
+        << std::setw(12) << rle.cellId.bytes() / MB
+        << std::setw(12) << bestOf([&] { return plain.massWhereCell(pred, count); })
+        << std::setw(12) << bestOf([&] { return dict.massWhereCell(pred, count); })
+        << std::setw(12) << bestOf([&] { return rle.massWhereCell(pred, count); })
+        << "\n";
+}
+
+int main()
+{
+    const size_t N = 10'000'000;
+
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    std::vector<float> mass(N);
+    for (size_t i = 0; i < N; i++) mass[i] = dist(rng);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "sum mass where cellId % 10 < 3 (" << N << " rows), cell id column in plain / dictionary / RLE encoding\n\n";
+    std::cout << std::setw(12) << "cardinality"
+        << std::setw(10) << "mean run"
+        << std::setw(10) << "runs"
+        << std::setw(12) << "plain MB"
+        << std::setw(12) << "dict MB"
+        << std::setw(12) << "rle MB"
+        << std::setw(12) << "plain ms"
+        << std::setw(12) << "dict ms"
+        << std::setw(12) << "rle ms"
+        << "\n";
+
+    for (size_t cardinality : { 16, 1000, 100000 })
+    {
+        for (size_t meanRun : { 1, 16, 1024 })
+        {
+            std::vector<int> cells = generateCells(N, cardinality, meanRun, rng);
+            // smallest code that fits the cardinality
+            if (cardinality <= 256) runCase<uint8_t>(cardinality, meanRun, cells, mass);
+            else if (cardinality <= 65536) runCase<uint16_t>(cardinality, meanRun, cells, mass);
+            else runCase<uint32_t>(cardinality, meanRun, cells, mass);
+        }
+    }
+    return 0;
+}
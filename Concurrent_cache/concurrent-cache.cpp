@@ -0,0 +1,300 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+#include <cmath>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+The usual LRU cache is std::list + std::unordered_map behind one mutex: every get splices a list node (pointer chasing,
+writes to 3 nodes) and every thread goes through the same lock, even for hits.
+ClockCache does it the other way:
+- SHARDS independent shards (by key hash), each with its entries in one contiguous slot array, so no per-entry allocation
+- the index is an open-addressing table (linear probing) of slot numbers, not a node-based hash map
+- recency is one "referenced" byte per slot instead of a list position: a hit just sets it (only if it's not set yet,
+  so hot entries don't keep writing the same cache line), eviction is CLOCK over the slot array
+- get() takes no lock at all: every slot has a seqlock version, the reader reads key + value and checks that the version
+  didn't change in between, so a slot that was overwritten during the read is just a miss
+- put() (after a miss) locks only its shard, runs the CLOCK hand, and removes the victim from the index with backward
+  shift deletion. A reader racing with that can miss an entry, which for a cache is fine.
+We compare hit rate and ops/s against the mutex-guarded LRU on a Zipf workload at 1..64 threads.
+*/
+
+inline uint64_t mix64(uint64_t v) // murmur3 finalizer
+{
+    v ^= v >> 33; v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33; v *= 0xc4ceb9fe1a85ec53ULL;
+    v ^= v >> 33;
+    return v;
+}
+
+// the "expensive" derived result we cache
+inline uint64_t computeValue(uint64_t key)
+{
+    uint64_t v = key;
+    for (int i = 0; i < 16; i++) v = mix64(v + i);
+    return v;
+}
+
+
+class ClockCache
+{
+    static constexpr size_t SHARDS = 64;
+
+    struct Slot
+    {
+        std::atomic<uint32_t> version{ 0 }; // odd while a writer changes the slot
+        std::atomic<uint64_t> key{ 0 };
+        std::atomic<uint64_t> value{ 0 };
+        std::atomic<uint8_t> referenced{ 0 };
+    };
+
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;
+        std::unique_ptr<Slot[]> slots;
+        std::unique_ptr<std::atomic<uint32_t>[]> index; // slot + 1, 0 = empty
+        size_t capacity = 0, indexMask = 0, hand = 0, used = 0;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+
+    static size_t shardOf(uint64_t hash) { return hash >> 58; } // top 6 bits, SHARDS = 64
+    static size_t homeOf(uint64_t hash, size_t mask) { return hash & mask; }
+
+    bool readSlot(const Slot& s, uint64_t key, uint64_t& value) const
+    {
+        uint32_t v1 = s.version.load(std::memory_order_acquire);
+        if (v1 & 1) return false;
+        uint64_t k = s.key.load(std::memory_order_relaxed);
+        uint64_t val = s.value.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.version.load(std::memory_order_relaxed) != v1 || k != key) return false;
+        value = val;
+        return true;
+    }
+
+    // under the shard lock: remove entry at index position pos, shift back the rest of its probe chain
+    void eraseIndex(Shard& sh, size_t pos)
+    {
+        size_t hole = pos;
+        for (size_t next = (pos + 1) & sh.indexMask; ; next = (next + 1) & sh.indexMask)
+        {
+            uint32_t entry = sh.index[next].load(std::memory_order_relaxed);
+            if (!entry) break;
+            size_t home = homeOf(mix64(sh.slots[entry - 1].key.load(std::memory_order_relaxed)), sh.indexMask);
+            // entry can move into the hole if its home is not in (hole, next]
+            bool canMove = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+            if (canMove)
+            {
+                sh.index[hole].store(entry, std::memory_order_release);
+                hole = next;
+            }
+        }
+        sh.index[hole].store(0, std::memory_order_release);
+    }
+
+public:
+    ClockCache(size_t capacity) : shards(new Shard[SHARDS])
+    {
+        size_t perShard = std::max<size_t>(1, capacity / SHARDS);
+        size_t indexSize = 1;
+        while (indexSize < 2 * perShard) indexSize <<= 1; // load factor <= 0.5
+        for (size_t i = 0; i < SHARDS; i++)
+        {
+            shards[i].capacity = perShard;
+            shards[i].slots.reset(new Slot[perShard]);
+            shards[i].index.reset(new std::atomic<uint32_t>[indexSize]);
+            for (size_t j = 0; j < indexSize; j++) shards[i].index[j].store(0, std::memory_order_relaxed);
+            shards[i].indexMask = indexSize - 1;
+        }
+    }
+
+    bool get(uint64_t key, uint64_t& value)
+    {
+        uint64_t hash = mix64(key);
+        Shard& sh = shards[shardOf(hash)];
+        for (size_t pos = homeOf(hash, sh.indexMask), probes = 0; probes <= sh.indexMask; pos = (pos + 1) & sh.indexMask, probes++)
+        {
+            uint32_t entry = sh.index[pos].load(std::memory_order_acquire);
+            if (!entry) return false;
+            Slot& s = sh.slots[entry - 1];
+            if (readSlot(s, key, value))
+            {
+                if (!s.referenced.load(std::memory_order_relaxed)) s.referenced.store(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void put(uint64_t key, uint64_t value)
+    {
+        uint64_t hash = mix64(key);
+        Shard& sh = shards[shardOf(hash)];
+        std::lock_guard<std::mutex> lock(sh.mutex);
+
+        // another thread may have inserted it while we computed the value
+        size_t pos = homeOf(hash, sh.indexMask);
+        for (uint32_t entry; (entry = sh.index[pos].load(std::memory_order_relaxed)); pos = (pos + 1) & sh.indexMask)
+            if (sh.slots[entry - 1].key.load(std::memory_order_relaxed) == key) return;
+
+        size_t victim;
+        if (sh.used < sh.capacity) victim = sh.used++;
+        else
+        {
+            while (true) // CLOCK: second chance for referenced slots
+            {
+                Slot& s = sh.slots[sh.hand];
+                victim = sh.hand;
+                sh.hand = (sh.hand + 1) % sh.capacity;
+                if (!s.referenced.load(std::memory_order_relaxed)) break;
+                s.referenced.store(0, std::memory_order_relaxed);
+            }
+            uint64_t oldKey = sh.slots[victim].key.load(std::memory_order_relaxed);
+            size_t p = homeOf(mix64(oldKey), sh.indexMask);
+            while (sh.index[p].load(std::memory_order_relaxed) != victim + 1) p = (p + 1) & sh.indexMask;
+            eraseIndex(sh, p);
+        }
+
+        Slot& s = sh.slots[victim];
+        uint32_t v = s.version.load(std::memory_order_relaxed);
+        s.version.store(v + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.key.store(key, std::memory_order_relaxed);
+        s.value.store(value, std::memory_order_relaxed);
+        s.version.store(v + 2, std::memory_order_release);
+        s.referenced.store(0, std::memory_order_relaxed);
+
+        pos = homeOf(hash, sh.indexMask);
+        while (sh.index[pos].load(std::memory_order_relaxed)) pos = (pos + 1) & sh.indexMask;
+        sh.index[pos].store(uint32_t(victim + 1), std::memory_order_release);
+    }
+};
+
+
+// the baseline: exact LRU, one lock
+class LruCache
+{
+    std::mutex mutex;
+    std::list<std::pair<uint64_t, uint64_t>> order; // front = most recent
+    std::unordered_map<uint64_t, std::list<std::pair<uint64_t, uint64_t>>::iterator> map;
+    size_t capacity;
+
+public:
+    LruCache(size_t capacity) : capacity(capacity) { map.reserve(capacity); }
+
+    bool get(uint64_t key, uint64_t& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = map.find(key);
+        if (it == map.end()) return false;
+        order.splice(order.begin(), order, it->second);
+        value = it->second->second;
+        return true;
+    }
+
+    void put(uint64_t key, uint64_t value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (map.count(key)) return;
+        order.emplace_front(key, value);
+        map[key] = order.begin();
+        if (map.size() > capacity)
+        {
+            map.erase(order.back().first);
+            order.pop_back();
+        }
+    }
+};
+
+
+struct RunResult
+{
+    double mops;
+    double hitRate;
+};
+
+template<typename Cache>
+RunResult run(Cache& cache, const std::vector<std::vector<uint64_t>>& keys)
+{
+    std::atomic<size_t> hits{ 0 }, wrong{ 0 };
+    std::vector<std::thread> workers;
+    auto start = Clock::now();
+    for (auto& threadKeys : keys)
+        workers.emplace_back([&] {
+            size_t localHits = 0, localWrong = 0;
+            for (uint64_t key : threadKeys)
+            {
+                uint64_t value;
+                if (cache.get(key, value)) localHits++, localWrong += value != computeValue(key);
+                else cache.put(key, computeValue(key));
+            }
+            hits += localHits;
+            wrong += localWrong;
+        });
+    for (auto& w : workers) w.join();
+    std::chrono::duration<double> duration = Clock::now() - start;
+    if (wrong) std::cout << "  warning: " << wrong << " hits returned a wrong value\n";
+
+    size_t ops = 0;
+    for (auto& threadKeys : keys) ops += threadKeys.size();
+    return { ops / duration.count() / 1e6, double(hits) / double(ops) };
+}
+
+int main()
+{
+    const size_t KEYS = 1'000'000;
+    const size_t CAPACITY = 100'000;
+    const size_t TOTAL_OPS = 8'000'000;
+    const double ZIPF = 0.99;
+
+    // Zipf sampler: cdf over ranks, keys are shuffled ranks so hot keys are spread over shards
+    std::vector<double> cdf(KEYS);
+    double total = 0;
+    for (size_t r = 0; r < KEYS; r++) cdf[r] = total += 1.0 / std::pow(double(r + 1), ZIPF);
+    std::vector<uint64_t> keyOfRank(KEYS);
+    for (size_t r = 0; r < KEYS; r++) keyOfRank[r] = r * 2654435761ull + 17;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Concurrent cache, " << CAPACITY << " entries, Zipf(" << ZIPF << ") over " << KEYS << " keys, "
+        << TOTAL_OPS << " ops per run (get, put on miss)\n";
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << "\n\n";
+    std::cout << std::setw(10) << "threads"
+        << std::setw(14) << "LRU Mops/s"
+        << std::setw(12) << "LRU hits"
+        << std::setw(16) << "CLOCK Mops/s"
+        << std::setw(14) << "CLOCK hits"
+        << "\n";
+
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<double> unit(0.0, total);
+    for (size_t threads : { 1, 2, 4, 8, 16, 32, 64 })
+    {
+        std::vector<std::vector<uint64_t>> keys(threads, std::vector<uint64_t>(TOTAL_OPS / threads));
+        for (auto& threadKeys : keys)
+            for (auto& key : threadKeys) key = keyOfRank[std::lower_bound(cdf.begin(), cdf.end(), unit(rng)) - cdf.begin()];
+
+        LruCache lru(CAPACITY);
+        ClockCache clock(CAPACITY);
+        RunResult lruResult = run(lru, keys);
+        RunResult clockResult = run(clock, keys);
+        std::cout << std::setw(10) << threads
+            << std::setw(14) << lruResult.mops
+            << std::setw(11) << lruResult.hitRate * 100 << "%"
+            << std::setw(16) << clockResult.mops
+            << std::setw(13) << clockResult.hitRate * 100 << "%"
+            << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,318 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <new>
+#include <string>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+In production several processes run on one box, each scanning its own particle arrays. They don't share data, but they
+share the last level cache and the memory bandwidth, so a layout that scales perfectly alone can stop scaling
+when N copies run at once.
+This benchmark runs N instances of the same workload at the same time, every instance with its own data:
+- threads: N threads in this process
+- processes: N forked processes (Linux only), like N separate services
+Every instance builds its data first, then waits at a start gate, so all instances scan at the same time. The gate and
+the results live in a MAP_SHARED mapping, so the same code works for threads and for forked children.
+Workloads are the AoS/SoA scans from AoS-SoA (sum mass where x > 0) and the std::vector / ChunkedVector traversals
+from Vector_allocation_benhmarks. We report the throughput of every instance (and slowest/median/fastest), the
+aggregate throughput, and the scaling efficiency: aggregate / (N * throughput of one instance alone).
+*/
+
+struct ParticleAos
+{
+    float x, y, z;
+    double mass; // same layout as in AoS-SoA
+};
+
+struct ParticlesSoA
+{
+    std::vector<float> x, y, z, mass;
+    ParticlesSoA(size_t n)
+    {
+        x.resize(n), y.resize(n), z.resize(n), mass.resize(n);
+    }
+};
+
+//CHUNKED VECTOR WITH NEW[] (same as in Vector_allocation_benhmarks)
+template<typename T, size_t CHUNK_SIZE = 64>
+class ChunkedVector {
+    std::vector<T*> chunks;
+    size_t size = 0;
+
+public:
+    ~ChunkedVector() {
+        for (auto chunk : chunks) delete[] chunk;
+    }
+
+    void push_back(const T& value) {
+        if (size % CHUNK_SIZE == 0)
+            chunks.push_back(new T[CHUNK_SIZE]);
+        chunks[size / CHUNK_SIZE][size % CHUNK_SIZE] = value;
+        size++;
+    }
+
+    T& operator[](size_t index) {
+        return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+
+    size_t get_size() const { return size; }
+};
+
+enum Workload { AosScan, SoaScan, VectorTraversal, ChunkedTraversal };
+const char* workloadNames[] = { "AoS scan", "SoA scan", "std::vector<int>", "ChunkedVector<int>" };
+
+constexpr int MAX_INSTANCES = 256;
+
+struct SharedState
+{
+    std::atomic<int> ready;
+    std::atomic<int> go;
+    double results[MAX_INSTANCES]; // elements per second of every instance
+};
+
+void waitAtGate(SharedState& shared)
+{
+    shared.ready.fetch_add(1);
+    while (!shared.go.load(std::memory_order_acquire)) std::this_thread::yield();
+}
+
+// builds its own data, waits for the others, returns elements per second
+double runInstance(Workload workload, size_t n, int repeats, SharedState& shared, unsigned seed)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    volatile double sink = 0;
+    Clock::time_point start;
+
+    switch (workload)
+    {
+    case AosScan:
+    {
+        std::vector<ParticleAos> particles(n);
+        for (auto& p : particles) p = { dist(rng), dist(rng), dist(rng), double(dist(rng)) };
+        waitAtGate(shared);
+        start = Clock::now();
+        for (int r = 0; r < repeats; r++)
+        {
+            double sum = 0;
+            for (size_t i = 0; i < n; i++) sum += particles[i].x > 0.0f ? particles[i].mass : 0.0;
+            sink = sink + sum;
+        }
+        break;
+    }
+    case SoaScan:
+    {
+        ParticlesSoA particles(n);
+        for (size_t i = 0; i < n; i++) particles.x[i] = dist(rng), particles.y[i] = dist(rng), particles.z[i] = dist(rng), particles.mass[i] = dist(rng);
+        waitAtGate(shared);
+        start = Clock::now();
+        for (int r = 0; r < repeats; r++)
+        {
+            double sum = 0;
+            for (size_t i = 0; i < n; i++) sum += particles.x[i] > 0.0f ? particles.mass[i] : 0.0f;
+            sink = sink + sum;
+        }
+        break;
+    }
+    case VectorTraversal:
+    {
+        std::vector<int> v;
+        for (size_t i = 0; i < n; i++) v.push_back(int(i));
+        waitAtGate(shared);
+        start = Clock::now();
+        for (int r = 0; r < repeats; r++)
+        {
+            long long sum = 0;
+            for (size_t i = 0; i < n; i++) sum += v[i];
+            sink = sink + double(sum);
+        }
+        break;
+    }
+    case ChunkedTraversal:
+    {
+        ChunkedVector<int> v;
+        for (size_t i = 0; i < n; i++) v.push_back(int(i));
+        waitAtGate(shared);
+        start = Clock::now();
+        for (int r = 0; r < repeats; r++)
+        {
+            long long sum = 0;
+            for (size_t i = 0; i < n; i++) sum += v[i];
+            sink = sink + double(sum);
+        }
+        break;
+    }
+    }
+    std::chrono::duration<double> duration = Clock::now() - start;
+    return double(n) * repeats / duration.count();
+}
+
+SharedState* createSharedState()
+{
+#ifdef __linux__
+    void* p = mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return nullptr;
+    return new (p) SharedState();
+#else
+    return new SharedState();
+#endif
+}
+
+void destroySharedState(SharedState* shared)
+{
+#ifdef __linux__
+    shared->~SharedState();
+    munmap(shared, sizeof(SharedState));
+#else
+    delete shared;
+#endif
+}
+
+#ifdef __linux__
+// waits until every child is at the gate, false if one of them exited before (crash, OOM kill) or after timeoutSeconds
+bool waitForChildren(SharedState& shared, std::vector<pid_t>& children, double timeoutSeconds)
+{
+    auto start = Clock::now();
+    while (shared.ready.load() < int(children.size()))
+    {
+        for (pid_t& pid : children)
+            if (pid > 0 && waitpid(pid, nullptr, WNOHANG) == pid)
+                pid = -1; // reaped, it will never reach the gate
+        if (std::find(children.begin(), children.end(), pid_t(-1)) != children.end()) return false;
+        if (std::chrono::duration<double>(Clock::now() - start).count() > timeoutSeconds) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+#endif
+
+// runs instances copies at once, fills results, false (and error) if the mode isn't supported here or an instance failed
+bool runConcurrent(Workload workload, int instances, bool processes, size_t n, int repeats, std::vector<double>& results, std::string& error)
+{
+    SharedState* shared = createSharedState();
+    if (!shared) { error = "mmap failed"; return false; }
+    shared->ready.store(0), shared->go.store(0);
+
+    if (processes)
+    {
+#ifdef __linux__
+        std::vector<pid_t> children;
+        for (int i = 0; i < instances; i++)
+        {
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                error = "fork() failed";
+                break;
+            }
+            if (pid == 0)
+            {
+                shared->results[i] = runInstance(workload, n, repeats, *shared, 100 + i);
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        if (error.empty() && !waitForChildren(*shared, children, 120.0))
+            error = "an instance died or hung before the start gate";
+        shared->go.store(1, std::memory_order_release); // also releases the children that made it when we give up
+        for (pid_t pid : children)
+        {
+            if (pid < 0) continue;
+            int status = 0;
+            waitpid(pid, &status, 0);
+            if (error.empty() && !(WIFEXITED(status) && WEXITSTATUS(status) == 0)) error = "an instance crashed";
+        }
+#else
+        error = "fork() not available";
+#endif
+    }
+    else
+    {
+        std::vector<std::thread> workers;
+        for (int i = 0; i < instances; i++)
+            workers.emplace_back([=] { shared->results[i] = runInstance(workload, n, repeats, *shared, 100 + i); });
+        while (shared->ready.load() < instances) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        shared->go.store(1, std::memory_order_release);
+        for (auto& w : workers) w.join();
+    }
+    if (error.empty()) results.assign(shared->results, shared->results + instances);
+    destroySharedState(shared);
+    return error.empty();
+}
+
+int main()
+{
+    const size_t N = 4'000'000; // per instance, well past a typical LLC share for every workload
+    const int REPEATS = 5;
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<int> instanceCounts;
+    for (int i = 1; i <= int(std::max(4u, hw)) && i <= MAX_INSTANCES; i *= 2) instanceCounts.push_back(i);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Concurrent instances, each with its own " << N << " elements (M elements/s), hardware threads: " << hw << "\n";
+    for (Workload workload : { AosScan, SoaScan, VectorTraversal, ChunkedTraversal })
+    {
+        std::cout << "\n== " << workloadNames[workload] << " ==\n";
+        std::cout << std::setw(12) << "mode"
+            << std::setw(11) << "instances"
+            << std::setw(14) << "slowest"
+            << std::setw(14) << "median"
+            << std::setw(14) << "fastest"
+            << std::setw(14) << "average"
+            << std::setw(14) << "aggregate"
+            << std::setw(14) << "efficiency"
+            << "    per instance"
+            << "\n";
+        double single = 0;
+        for (bool processes : { false, true })
+        {
+            for (int instances : instanceCounts)
+            {
+                std::vector<double> results;
+                std::string error;
+                if (!runConcurrent(workload, instances, processes, N, REPEATS, results, error))
+                {
+                    std::cout << std::setw(12) << (processes ? "processes" : "threads") << std::setw(11) << instances
+                        << "  " << error << ", skipped\n";
+                    break;
+                }
+                std::vector<double> sorted = results;
+                std::sort(sorted.begin(), sorted.end());
+                double slowest = sorted.front(), fastest = sorted.back();
+                double median = sorted.size() % 2 ? sorted[sorted.size() / 2] : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2;
+                double total = 0;
+                for (double r : results) total += r;
+                if (!processes && instances == 1) single = total;
+                std::cout << std::setw(12) << (processes ? "processes" : "threads")
+                    << std::setw(11) << instances
+                    << std::setw(14) << slowest / 1e6
+                    << std::setw(14) << median / 1e6
+                    << std::setw(14) << fastest / 1e6
+                    << std::setw(14) << total / instances / 1e6
+                    << std::setw(14) << total / 1e6
+                    << std::setw(13) << 100.0 * total / (instances * single) << "%"
+                    << "   ";
+                // every instance in start order, an unfair LLC split shows up as a spread here
+                if (instances <= 16)
+                    for (double r : results) std::cout << " " << r / 1e6;
+                else std::cout << " (" << instances << " instances, see min/median/max)";
+                std::cout << "\n";
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,466 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <cmath>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+Our processing runs ingest -> convert AoS to SoA -> filter (x > 0) -> aggregate (mass per grid cell) one stage after
+another over the whole batch. A row is only aggregated after everything has been ingested and converted, so latency is
+the whole batch, and the intermediate arrays of every stage are much bigger than the caches.
+The dataflow version cuts the stream into chunks and runs every stage as its own worker (or pool of workers), pinned to
+its own cpu. Stages are connected by bounded queues of ChunkDesc, small descriptors (buffer index, row count, sequence
+number, ingest time) that point into pooled buffers, the rows themselves are never copied between queues:
+- SpscQueue: ring buffer with one producer and one consumer, head and tail on their own cache lines
+- MpmcQueue: bounded queue with a sequence number per cell (Vyukov), for stages that are pools of workers
+- ChunkPool: a fixed set of buffers, free buffer indices live in an MpmcQueue. convert gives the AoS buffer back as soon
+  as it has been converted, aggregate gives the SoA buffer back, so the same few buffers circulate and stay warm.
+Backpressure: a full queue or an empty pool makes the upstream worker wait (yield), so a slow stage throttles ingest
+instead of letting memory grow. End of stream is a ChunkDesc with last set, the last worker of a pool to see it
+forwards it to every worker of the next stage.
+Latency of a chunk = from the start of its ingest to the end of its aggregation.
+*/
+
+struct ParticleAos
+{
+    float x, y, z;
+    double mass; // same layout as in AoS-SoA
+};
+
+struct ParticlesSoA
+{
+    std::vector<float> x, y, z, mass;
+    ParticlesSoA(size_t n)
+    {
+        x.resize(n), y.resize(n), z.resize(n), mass.resize(n);
+    }
+};
+
+constexpr int CELLS = 64; // 8 x 8 grid over (x, y)
+
+// ---------- thread pinning (same as Helper_thread_prefetching) ----------
+
+bool pinCurrentThread(int cpu)
+{
+#ifdef __linux__
+    if (cpu < 0) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+
+// ---------- queues ----------
+
+template<typename T>
+class SpscQueue
+{
+    std::unique_ptr<T[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{ 0 }; // next to pop, written by the consumer
+    alignas(64) std::atomic<size_t> tail{ 0 }; // next to push, written by the producer
+
+public:
+    static constexpr bool singleProducer = true;
+
+    SpscQueue(size_t capacity) : cells(new T[capacity]), mask(capacity - 1) {} // capacity is a power of 2
+
+    bool try_push(const T& value)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) return false; // full
+        cells[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& value)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false; // empty
+        value = cells[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+template<typename T>
+class MpmcQueue
+{
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+
+public:
+    static constexpr bool singleProducer = false;
+
+    MpmcQueue(size_t capacity) : cells(new Cell[capacity]), mask(capacity - 1) // capacity is a power of 2
+    {
+        for (size_t i = 0; i < capacity; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool try_push(const T& value)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = cells[t & mask];
+            intptr_t diff = intptr_t(cell.sequence.load(std::memory_order_acquire)) - intptr_t(t);
+            if (diff == 0)
+            {
+                if (tail.compare_exchange_weak(t, t + 1, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.sequence.store(t + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) return false; // full
+            else t = tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool try_pop(T& value)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = cells[h & mask];
+            intptr_t diff = intptr_t(cell.sequence.load(std::memory_order_acquire)) - intptr_t(h + 1);
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(h, h + 1, std::memory_order_relaxed))
+                {
+                    value = cell.value;
+                    cell.sequence.store(h + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) return false; // empty
+            else h = head.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// blocking versions, waiting here is the backpressure
+template<typename Queue, typename T>
+void push(Queue& q, const T& value)
+{
+    while (!q.try_push(value)) std::this_thread::yield();
+}
+
+template<typename Queue, typename T>
+T pop(Queue& q)
+{
+    T value;
+    while (!q.try_pop(value)) std::this_thread::yield();
+    return value;
+}
+
+size_t roundUpPow2(size_t n)
+{
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+
+// ---------- pooled buffers ----------
+
+template<typename Buffer>
+class ChunkPool
+{
+    std::vector<Buffer> buffers;
+    MpmcQueue<uint32_t> free;
+
+public:
+    ChunkPool(size_t count, size_t rows) : free(roundUpPow2(count))
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            buffers.emplace_back(rows);
+            free.try_push(uint32_t(i));
+        }
+    }
+
+    uint32_t acquire() { return pop<MpmcQueue<uint32_t>, uint32_t>(free); } // waits while every buffer is in flight
+    void release(uint32_t index) { push(free, index); }
+    Buffer& operator[](uint32_t index) { return buffers[index]; }
+};
+
+struct ChunkDesc
+{
+    uint32_t buffer;
+    uint32_t count;
+    uint64_t seq;
+    Clock::time_point ingested;
+    bool last;
+};
+
+
+// ---------- the stages, shared by the pipeline and the sequential version ----------
+
+inline uint64_t splitmix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+inline float coordinate(uint64_t h) { return float(h >> 40) * (2000.0f / 16777216.0f) - 1000.0f; }
+
+// row values depend only on the global row index, so every version sees the same data
+void ingest(ParticleAos* out, size_t firstRow, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t h = splitmix(firstRow + i);
+        out[i] = { coordinate(h), coordinate(splitmix(h)), coordinate(splitmix(h + 1)), double(h & 0xffff) / 65536.0 };
+    }
+}
+
+void convert(const ParticleAos* in, ParticlesSoA& out, size_t offset, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        out.x[offset + i] = in[i].x, out.y[offset + i] = in[i].y;
+        out.z[offset + i] = in[i].z, out.mass[offset + i] = float(in[i].mass);
+    }
+}
+
+// keeps rows with x > 0 in place, returns how many
+size_t filter(ParticlesSoA& p, size_t offset, size_t count)
+{
+    size_t kept = offset;
+    for (size_t i = offset; i < offset + count; i++)
+    {
+        p.x[kept] = p.x[i], p.y[kept] = p.y[i], p.z[kept] = p.z[i], p.mass[kept] = p.mass[i];
+        kept += p.x[i] > 0.0f; // branchless compaction
+    }
+    return kept - offset;
+}
+
+struct Aggregate
+{
+    double mass[CELLS] = {};
+    size_t rows = 0;
+
+    void add(const ParticlesSoA& p, size_t offset, size_t count)
+    {
+        for (size_t i = offset; i < offset + count; i++)
+        {
+            int cx = std::min(7, int((p.x[i] + 1000.0f) / 250.0f));
+            int cy = std::min(7, int((p.y[i] + 1000.0f) / 250.0f));
+            mass[cx * 8 + cy] += p.mass[i];
+        }
+        rows += count;
+    }
+
+    double total() const
+    {
+        double sum = 0;
+        for (double m : mass) sum += m;
+        return sum;
+    }
+};
+
+struct Result
+{
+    double rowsPerSecond;
+    std::vector<double> latencyMs; // one per chunk
+    Aggregate aggregate;
+};
+
+
+// ---------- sequential: every stage over the whole batch ----------
+
+Result runSequential(size_t n, size_t chunkRows)
+{
+    size_t chunks = (n + chunkRows - 1) / chunkRows;
+    std::vector<Clock::time_point> ingested(chunks);
+    Result result;
+    result.latencyMs.resize(chunks);
+
+    auto start = Clock::now();
+    std::vector<ParticleAos> aos(n);
+    for (size_t c = 0; c < chunks; c++)
+    {
+        ingested[c] = Clock::now();
+        ingest(aos.data() + c * chunkRows, c * chunkRows, std::min(chunkRows, n - c * chunkRows));
+    }
+    ParticlesSoA soa(n);
+    convert(aos.data(), soa, 0, n);
+    std::vector<size_t> kept(chunks); // compacted per chunk, so we can still time chunks in the aggregate stage
+    for (size_t c = 0; c < chunks; c++) kept[c] = filter(soa, c * chunkRows, std::min(chunkRows, n - c * chunkRows));
+    for (size_t c = 0; c < chunks; c++)
+    {
+        result.aggregate.add(soa, c * chunkRows, kept[c]);
+        std::chrono::duration<double, std::milli> latency = Clock::now() - ingested[c];
+        result.latencyMs[c] = latency.count();
+    }
+    std::chrono::duration<double> duration = Clock::now() - start;
+    result.rowsPerSecond = double(n) / duration.count();
+    return result;
+}
+
+
+// ---------- dataflow pipeline ----------
+
+// ingest (1 worker) -> convert (workers) -> filter (workers) -> aggregate (1 worker)
+// Queue = SpscQueue needs workers == 1
+template<template<typename> class Queue>
+Result runPipeline(size_t n, size_t chunkRows, unsigned workers, size_t queueCapacity)
+{
+    if (Queue<ChunkDesc>::singleProducer && workers != 1) workers = 1;
+    size_t capacity = roundUpPow2(queueCapacity);
+    size_t chunks = (n + chunkRows - 1) / chunkRows;
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+
+    ChunkPool<std::vector<ParticleAos>> aosPool(capacity + workers + 1, chunkRows);
+    ChunkPool<ParticlesSoA> soaPool(2 * capacity + 2 * workers + 1, chunkRows);
+    Queue<ChunkDesc> toConvert(capacity), toFilter(capacity), toAggregate(capacity);
+    std::atomic<unsigned> convertDone{ 0 }, filterDone{ 0 };
+
+    Result result;
+    result.latencyMs.resize(chunks);
+    std::vector<std::thread> threads;
+    unsigned nextCpu = 0;
+    auto spawn = [&](auto body) {
+        int cpu = int(nextCpu++ % hw);
+        threads.emplace_back([=] { pinCurrentThread(cpu); body(); });
+    };
+
+    auto start = Clock::now();
+    spawn([&] {
+        for (size_t c = 0; c < chunks; c++)
+        {
+            Clock::time_point now = Clock::now();
+            uint32_t buffer = aosPool.acquire();
+            uint32_t count = uint32_t(std::min(chunkRows, n - c * chunkRows));
+            ingest(aosPool[buffer].data(), c * chunkRows, count);
+            push(toConvert, ChunkDesc{ buffer, count, c, now, false });
+        }
+        for (unsigned w = 0; w < workers; w++) push(toConvert, ChunkDesc{ 0, 0, 0, {}, true });
+    });
+    for (unsigned w = 0; w < workers; w++)
+        spawn([&] {
+            while (true)
+            {
+                ChunkDesc desc = pop<Queue<ChunkDesc>, ChunkDesc>(toConvert);
+                if (desc.last) break;
+                uint32_t buffer = soaPool.acquire();
+                convert(aosPool[desc.buffer].data(), soaPool[buffer], 0, desc.count);
+                aosPool.release(desc.buffer); // recycled right away, ingest can refill it
+                desc.buffer = buffer;
+                push(toFilter, desc);
+            }
+            if (convertDone.fetch_add(1) + 1 == workers) // the last convert worker ends the filter stage
+                for (unsigned f = 0; f < workers; f++) push(toFilter, ChunkDesc{ 0, 0, 0, {}, true });
+        });
+    for (unsigned w = 0; w < workers; w++)
+        spawn([&] {
+            while (true)
+            {
+                ChunkDesc desc = pop<Queue<ChunkDesc>, ChunkDesc>(toFilter);
+                if (desc.last) break;
+                desc.count = uint32_t(filter(soaPool[desc.buffer], 0, desc.count));
+                push(toAggregate, desc);
+            }
+            if (filterDone.fetch_add(1) + 1 == workers)
+                push(toAggregate, ChunkDesc{ 0, 0, 0, {}, true });
+        });
+    spawn([&] {
+        while (true)
+        {
+            ChunkDesc desc = pop<Queue<ChunkDesc>, ChunkDesc>(toAggregate);
+            if (desc.last) break;
+            result.aggregate.add(soaPool[desc.buffer], 0, desc.count);
+            soaPool.release(desc.buffer);
+            std::chrono::duration<double, std::milli> latency = Clock::now() - desc.ingested;
+            result.latencyMs[desc.seq] = latency.count();
+        }
+    });
+    for (auto& t : threads) t.join();
+    std::chrono::duration<double> duration = Clock::now() - start;
+    result.rowsPerSecond = double(n) / duration.count();
+    return result;
+}
+
+
+double percentile(std::vector<double> values, double p)
+{
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, size_t(p * values.size()))];
+}
+
+void printRow(const char* mode, unsigned workers, size_t chunkRows, const Result& r, const Result& reference)
+{
+    std::cout << std::setw(14) << mode
+        << std::setw(9) << workers
+        << std::setw(9) << chunkRows
+        << std::setw(12) << r.rowsPerSecond / 1e6
+        << std::setw(12) << percentile(r.latencyMs, 0.5)
+        << std::setw(12) << percentile(r.latencyMs, 0.99)
+        << std::setw(12) << percentile(r.latencyMs, 1.0)
+        << "\n";
+    if (r.aggregate.rows != reference.aggregate.rows ||
+        std::fabs(r.aggregate.total() - reference.aggregate.total()) > 1e-9 * reference.aggregate.total())
+        std::cout << "  warning: aggregate differs from the sequential run\n";
+}
+
+int main()
+{
+    const size_t N = 20'000'000;
+    const size_t QUEUE_CAPACITY = 8; // chunks in flight between two stages
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "ingest -> AoS to SoA -> filter x > 0 -> aggregate, " << N << " rows, hardware threads: " << hw << "\n";
+    std::cout << "workers = workers per convert/filter stage, throughput in M rows/s, chunk latency in ms\n\n";
+    std::cout << std::setw(14) << "mode"
+        << std::setw(9) << "workers"
+        << std::setw(9) << "chunk"
+        << std::setw(12) << "M rows/s"
+        << std::setw(12) << "p50"
+        << std::setw(12) << "p99"
+        << std::setw(12) << "max"
+        << "\n";
+
+    std::vector<unsigned> workerCounts = { 2 };
+    if (hw >= 8) workerCounts.push_back((hw - 2) / 2);
+    for (size_t chunkRows : { size_t(4096), size_t(65536) })
+    {
+        Result sequential = runSequential(N, chunkRows);
+        printRow("sequential", 1, chunkRows, sequential, sequential);
+        printRow("spsc", 1, chunkRows, runPipeline<SpscQueue>(N, chunkRows, 1, QUEUE_CAPACITY), sequential);
+        for (unsigned workers : workerCounts)
+            printRow("mpmc", workers, chunkRows, runPipeline<MpmcQueue>(N, chunkRows, workers, QUEUE_CAPACITY), sequential);
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,395 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <cmath>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+A read-optimized SoA column store is sorted (here by x), so a range query like x > 0 is a binary search plus one
+sequential pass. But updating a row in place means moving it to its new sorted position, shifting everything in between.
+
+So we split the table in two:
+- main store: sorted SoA columns, read-only between merges
+- delta store: small row-wise buffer of changed rows (update, insert, erase), carved from pooled blocks like PoolAllocator does
+Updates only touch the delta and set a "stale" bit for the old main row. Scans walk main (skipping stale rows, 64 at a time
+via the bitmap) and then add the delta rows on the fly.
+When the delta gets big, a background thread merges main + delta into a new sorted main. While it runs, the delta is frozen
+and new writes go to a fresh delta, so writers never wait for the merge.
+*/
+
+struct DeltaRow
+{
+    uint32_t rowId;
+    float x, mass;
+    bool erased;
+};
+
+class DeltaStore
+{
+    static constexpr size_t BLOCK = 4096; // rows per pooled block
+    std::vector<DeltaRow*> blocks;
+    size_t count = 0;
+    std::vector<int32_t> slotOfRow; // rowId -> slot, -1 if the row is not in this delta
+
+public:
+    ~DeltaStore() {
+        for (auto block : blocks) delete[] block;
+    }
+
+    DeltaRow& at(size_t slot) const { return blocks[slot / BLOCK][slot % BLOCK]; }
+
+    const DeltaRow* find(uint32_t rowId) const
+    {
+        return rowId < slotOfRow.size() && slotOfRow[rowId] >= 0 ? &at(slotOfRow[rowId]) : nullptr;
+    }
+
+    // updating a row twice overwrites its slot, the delta never holds two versions of one row
+    DeltaRow& upsert(uint32_t rowId)
+    {
+        if (rowId >= slotOfRow.size()) slotOfRow.resize(std::max<size_t>(rowId + 1, slotOfRow.size() * 2), -1);
+        if (slotOfRow[rowId] >= 0) return at(slotOfRow[rowId]);
+        if (count / BLOCK == blocks.size()) blocks.push_back(new DeltaRow[BLOCK]);
+        slotOfRow[rowId] = (int32_t)count;
+        DeltaRow& row = at(count++);
+        row.rowId = rowId;
+        return row;
+    }
+
+    size_t size() const { return count; }
+
+    void reserveRows(size_t rows) { slotOfRow.resize(std::max(slotOfRow.size(), rows), -1); }
+
+    // blocks stay allocated, the next delta reuses them
+    void clear()
+    {
+        for (size_t slot = 0; slot < count; slot++) slotOfRow[at(slot).rowId] = -1;
+        count = 0;
+    }
+};
+
+struct MainStore
+{
+    std::vector<float> x, mass; // sorted by x
+    std::vector<uint32_t> rowId;
+};
+
+class DeltaTable
+{
+    std::unique_ptr<MainStore> main = std::make_unique<MainStore>();
+    std::vector<uint64_t> stale;           // bit per main row, set when the row has a newer version in a delta
+    std::vector<int32_t> positionOfRow;    // rowId -> position in main, -1 if not in main
+    std::unique_ptr<DeltaStore> active = std::make_unique<DeltaStore>();
+    std::unique_ptr<DeltaStore> frozen = std::make_unique<DeltaStore>(); // being merged, read-only
+    uint32_t nextRowId = 0;
+    size_t mergeThreshold;
+
+    std::thread merger;
+    bool merging = false;
+    size_t merges = 0;
+    std::atomic<bool> mergeDone{ false };
+    std::unique_ptr<MainStore> merged;
+    std::vector<int32_t> mergedPositions;
+
+    void markStale(uint32_t rowId)
+    {
+        int32_t p = positionOfRow[rowId];
+        if (p >= 0) stale[p / 64] |= 1ull << (p % 64);
+    }
+
+    // runs on the merge thread, reads only main columns, the stale snapshot and the frozen delta
+    void buildMerged(std::vector<uint64_t> staleSnapshot, uint32_t rowCount)
+    {
+        std::vector<DeltaRow> fresh;
+        fresh.reserve(frozen->size());
+        for (size_t slot = 0; slot < frozen->size(); slot++)
+            if (!frozen->at(slot).erased) fresh.push_back(frozen->at(slot));
+        std::sort(fresh.begin(), fresh.end(), [](const DeltaRow& a, const DeltaRow& b) { return a.x < b.x; });
+
+        auto next = std::make_unique<MainStore>();
+        size_t n = main->x.size();
+        next->x.reserve(n + fresh.size()), next->mass.reserve(n + fresh.size()), next->rowId.reserve(n + fresh.size());
+        size_t i = 0, j = 0;
+        while (i < n || j < fresh.size())
+        {
+            if (i < n && (staleSnapshot[i / 64] >> (i % 64) & 1)) { i++; continue; }
+            if (j == fresh.size() || (i < n && main->x[i] <= fresh[j].x))
+            {
+                next->x.push_back(main->x[i]), next->mass.push_back(main->mass[i]), next->rowId.push_back(main->rowId[i]);
+                i++;
+            }
+            else
+            {
+                next->x.push_back(fresh[j].x), next->mass.push_back(fresh[j].mass), next->rowId.push_back(fresh[j].rowId);
+                j++;
+            }
+        }
+        mergedPositions.assign(rowCount, -1);
+        for (size_t p = 0; p < next->rowId.size(); p++) mergedPositions[next->rowId[p]] = (int32_t)p;
+        merged = std::move(next);
+        mergeDone.store(true, std::memory_order_release);
+    }
+
+    // installs a finished merge, called from the owning thread at the start of every operation
+    void pollMerge()
+    {
+        if (!merging || !mergeDone.load(std::memory_order_acquire)) return;
+        merger.join();
+        main = std::move(merged);
+        positionOfRow = std::move(mergedPositions);
+        positionOfRow.resize(nextRowId, -1); // rows inserted while the merge was running
+        frozen->clear();
+        stale.assign((main->x.size() + 63) / 64, 0);
+        for (size_t slot = 0; slot < active->size(); slot++) markStale(active->at(slot).rowId);
+        merging = false;
+        merges++;
+        mergeDone.store(false, std::memory_order_relaxed);
+    }
+
+public:
+    DeltaTable(const std::vector<float>& x, const std::vector<float>& mass, size_t mergeThreshold)
+        : mergeThreshold(mergeThreshold)
+    {
+        std::vector<uint32_t> order(x.size());
+        for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return x[a] < x[b]; });
+        positionOfRow.resize(x.size());
+        for (uint32_t id : order)
+        {
+            positionOfRow[id] = (int32_t)main->x.size();
+            main->x.push_back(x[id]), main->mass.push_back(mass[id]), main->rowId.push_back(id);
+        }
+        stale.assign((x.size() + 63) / 64, 0);
+        nextRowId = (uint32_t)x.size();
+        active->reserveRows(x.size()), frozen->reserveRows(x.size());
+    }
+
+    ~DeltaTable() {
+        if (merger.joinable()) merger.join();
+    }
+
+    void update(uint32_t rowId, float x, float mass)
+    {
+        pollMerge();
+        active->upsert(rowId) = { rowId, x, mass, false };
+        markStale(rowId);
+        if (active->size() >= mergeThreshold) startMerge();
+    }
+
+    uint32_t insert(float x, float mass)
+    {
+        pollMerge();
+        uint32_t rowId = nextRowId++;
+        positionOfRow.push_back(-1);
+        active->upsert(rowId) = { rowId, x, mass, false };
+        if (active->size() >= mergeThreshold) startMerge();
+        return rowId;
+    }
+
+    void erase(uint32_t rowId)
+    {
+        pollMerge();
+        active->upsert(rowId) = { rowId, 0.0f, 0.0f, true };
+        markStale(rowId);
+        if (active->size() >= mergeThreshold) startMerge(); // tombstones count too, a delete-only stream must merge as well
+    }
+
+    // freezes the current delta and merges it on a background thread, does nothing if a merge is already running
+    void startMerge()
+    {
+        if (merging || active->size() == 0) return;
+        std::swap(active, frozen);
+        merging = true;
+        merger = std::thread(&DeltaTable::buildMerged, this, stale, nextRowId);
+    }
+
+    void waitForMerge()
+    {
+        if (!merging) return;
+        while (!mergeDone.load(std::memory_order_acquire)) std::this_thread::yield();
+        pollMerge();
+    }
+
+    size_t mergeCount() const { return merges; }
+    size_t deltaSize() const { return active->size() + (merging ? frozen->size() : 0); }
+
+    // sum of mass where x > 0: binary search in main, skip stale rows, then add delta rows
+    double sumMassPositiveX()
+    {
+        pollMerge();
+        const std::vector<float>& x = main->x;
+        const std::vector<float>& mass = main->mass;
+        size_t p = std::upper_bound(x.begin(), x.end(), 0.0f) - x.begin();
+        size_t n = x.size();
+        double sum = 0;
+        while (p < n && p % 64) { if (!(stale[p / 64] >> (p % 64) & 1)) sum += mass[p]; p++; }
+        for (; p + 64 <= n; p += 64)
+        {
+            uint64_t word = stale[p / 64];
+            if (!word) { for (size_t k = p; k < p + 64; k++) sum += mass[k]; } // common case, nothing changed here
+            else for (size_t k = p; k < p + 64; k++) if (!(word >> (k - p) & 1)) sum += mass[k];
+        }
+        for (; p < n; p++) if (!(stale[p / 64] >> (p % 64) & 1)) sum += mass[p];
+
+        if (merging)
+            for (size_t slot = 0; slot < frozen->size(); slot++)
+            {
+                const DeltaRow& r = frozen->at(slot);
+                if (!r.erased && r.x > 0.0f && !active->find(r.rowId)) sum += r.mass;
+            }
+        for (size_t slot = 0; slot < active->size(); slot++)
+        {
+            const DeltaRow& r = active->at(slot);
+            if (!r.erased && r.x > 0.0f) sum += r.mass;
+        }
+        return sum;
+    }
+};
+
+
+/*/
+Baseline: the same sorted SoA columns updated in place. Moving a row to its new sorted position shifts every row between
+the old and the new position in all columns, and their positions have to be fixed too.
+*/
+class InPlaceSortedTable
+{
+    std::vector<float> x, mass;
+    std::vector<uint32_t> rowId;
+    std::vector<int32_t> positionOfRow;
+
+public:
+    InPlaceSortedTable(const std::vector<float>& xs, const std::vector<float>& masses)
+    {
+        std::vector<uint32_t> order(xs.size());
+        for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return xs[a] < xs[b]; });
+        positionOfRow.resize(xs.size());
+        for (uint32_t id : order)
+        {
+            positionOfRow[id] = (int32_t)x.size();
+            x.push_back(xs[id]), mass.push_back(masses[id]), rowId.push_back(id);
+        }
+    }
+
+    void update(uint32_t id, float newX, float newMass)
+    {
+        size_t from = positionOfRow[id];
+        size_t to = std::upper_bound(x.begin(), x.end(), newX) - x.begin();
+        if (to > from) to--; // the row itself leaves its old slot
+        auto shift = [&](auto& column) {
+            auto value = column[from];
+            if (to > from) std::move(column.begin() + from + 1, column.begin() + to + 1, column.begin() + from);
+            else std::move_backward(column.begin() + to, column.begin() + from, column.begin() + from + 1);
+            column[to] = value;
+        };
+        shift(x), shift(mass), shift(rowId);
+        x[to] = newX, mass[to] = newMass;
+        for (size_t p = std::min(from, to); p <= std::max(from, to); p++) positionOfRow[rowId[p]] = (int32_t)p;
+    }
+
+    double sumMassPositiveX() const
+    {
+        double sum = 0;
+        for (size_t p = std::upper_bound(x.begin(), x.end(), 0.0f) - x.begin(); p < x.size(); p++) sum += mass[p];
+        return sum;
+    }
+};
+
+
+int main()
+{
+    const size_t N = 2'000'000;
+    const std::vector<double> updateRatios = { 0.001, 0.01, 0.05, 0.2 };
+    const size_t IN_PLACE_SAMPLE = 2'000; // in-place updates are O(n) each, we time a sample and report per-update cost
+
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    std::vector<float> x(N), mass(N);
+    for (size_t i = 0; i < N; i++) x[i] = dist(rng), mass[i] = dist(rng);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Delta store vs in-place updates on a sorted SoA table (" << N << " rows)\n\n";
+    std::cout << std::setw(10) << "updates"
+        << std::setw(16) << "delta Kupd/s"
+        << std::setw(18) << "in-place Kupd/s"
+        << std::setw(17) << "scan ms (delta)"
+        << std::setw(18) << "scan ms (merged)"
+        << std::setw(17) << "scan ms (plain)"
+        << std::setw(12) << "merge ms"
+        << "\n";
+
+    std::uniform_int_distribution<uint32_t> pick(0, N - 1);
+    for (double ratio : updateRatios)
+    {
+        size_t updates = size_t(ratio * N);
+        std::vector<uint32_t> ids(updates);
+        std::vector<float> newX(updates), newMass(updates);
+        for (size_t k = 0; k < updates; k++) ids[k] = pick(rng), newX[k] = dist(rng), newMass[k] = dist(rng);
+
+        // expected result from an unsorted copy
+        std::vector<float> expectX = x, expectMass = mass;
+        for (size_t k = 0; k < updates; k++) expectX[ids[k]] = newX[k], expectMass[ids[k]] = newMass[k];
+        double expected = 0;
+        for (size_t i = 0; i < N; i++) if (expectX[i] > 0.0f) expected += expectMass[i];
+
+        DeltaTable table(x, mass, SIZE_MAX); // merge only when we ask for it
+        auto start = Clock::now();
+        for (size_t k = 0; k < updates; k++) table.update(ids[k], newX[k], newMass[k]);
+        std::chrono::duration<double> deltaUpdate = Clock::now() - start;
+
+        start = Clock::now();
+        volatile double deltaSum = table.sumMassPositiveX();
+        std::chrono::duration<double, std::milli> deltaScan = Clock::now() - start;
+
+        start = Clock::now();
+        table.startMerge();
+        table.waitForMerge();
+        std::chrono::duration<double, std::milli> mergeTime = Clock::now() - start;
+
+        start = Clock::now();
+        volatile double mergedSum = table.sumMassPositiveX();
+        std::chrono::duration<double, std::milli> mergedScan = Clock::now() - start;
+
+        InPlaceSortedTable inPlace(x, mass);
+        size_t sample = std::min(updates, IN_PLACE_SAMPLE);
+        start = Clock::now();
+        for (size_t k = 0; k < sample; k++) inPlace.update(ids[k], newX[k], newMass[k]);
+        std::chrono::duration<double> inPlaceUpdate = Clock::now() - start;
+
+        start = Clock::now();
+        volatile double plainSum = inPlace.sumMassPositiveX();
+        std::chrono::duration<double, std::milli> plainScan = Clock::now() - start;
+        (void)plainSum;
+
+        std::cout << std::setw(9) << ratio * 100 << "%"
+            << std::setw(16) << updates / deltaUpdate.count() / 1e3
+            << std::setw(18) << sample / inPlaceUpdate.count() / 1e3
+            << std::setw(17) << deltaScan.count()
+            << std::setw(18) << mergedScan.count()
+            << std::setw(17) << plainScan.count()
+            << std::setw(12) << mergeTime.count()
+            << "\n";
+        double tolerance = 1e-6 * std::abs(expected) + 1.0;
+        if (std::abs(deltaSum - expected) > tolerance || std::abs(mergedSum - expected) > tolerance)
+            std::cout << "  warning: result mismatch (" << deltaSum << ", " << mergedSum << " vs " << expected << ")\n";
+    }
+
+    // background merge: writes keep going into a fresh delta while the old one is merged
+    DeltaTable table(x, mass, N / 100);
+    for (size_t k = 0; k < N / 10; k++) table.update(pick(rng), dist(rng), dist(rng));
+    for (size_t k = 0; k < 1000; k++) table.insert(dist(rng), dist(rng));
+    size_t leftBeforeFlush = table.deltaSize();
+    table.waitForMerge();
+    table.startMerge();
+    table.waitForMerge();
+    std::cout << "\nbackground merges with threshold " << N / 100 << ": " << table.mergeCount() << " merges, "
+        << leftBeforeFlush << " delta rows before the final flush, " << table.deltaSize() << " after\n";
+    return 0;
+}
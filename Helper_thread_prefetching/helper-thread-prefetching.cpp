@@ -0,0 +1,313 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <string>
+#include <cstring>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+Some traversals are latency bound, not bandwidth bound: walking a linked list or reading a ChunkedVector at random indices.
+Every load depends on an address we only know at the last moment, so a software prefetch inside the loop is often too late
+(for a linked list we can't even compute the address of node k+8 without walking there first).
+
+Helper-thread prefetching runs a stripped-down copy of the traversal on the SMT sibling of the main thread.
+Both hyperthreads share the same L1/L2, so whatever the helper touches is already warm when the main thread gets there.
+The helper does no real work, it only loads addresses, and it is throttled so it stays at most WINDOW elements ahead,
+otherwise it would run too far and evict the lines before the main thread uses them.
+
+This mode is opt-in (run with --helper), because it only makes sense when the two threads really share one physical core.
+*/
+
+constexpr size_t WINDOW = 256;        // how far the helper may run ahead of the main thread
+constexpr size_t PREFETCH_DISTANCE = 16; // distance for in-loop prefetch
+constexpr size_t PUBLISH_EVERY = 32;  // main thread publishes its position every PUBLISH_EVERY elements
+
+inline void prefetch(const void* p)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p);
+#else
+    (void)p;
+#endif
+}
+
+
+//CHUNKED VECTOR WITH NEW[] (same as in Vector_allocation_benhmarks)
+template<typename T, size_t CHUNK_SIZE = 64>
+class ChunkedVector {
+    std::vector<T*> chunks;
+    size_t size = 0;
+
+public:
+    ~ChunkedVector() {
+        for (auto chunk : chunks) delete[] chunk;
+    }
+
+    void push_back(const T& value) {
+        if (size % CHUNK_SIZE == 0)
+            chunks.push_back(new T[CHUNK_SIZE]);
+        chunks[size / CHUNK_SIZE][size % CHUNK_SIZE] = value;
+        size++;
+    }
+
+    T& operator[](size_t index) {
+        return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+
+    size_t get_size() const { return size; }
+};
+
+
+struct Node
+{
+    Node* next;
+    long long value;
+    char payload[48]; // we pad node to one cache line so every hop is a new line
+};
+
+/*/
+Nodes live in one vector, but we link them in random order, so following next jumps all over memory like a real heap-allocated list.
+*/
+struct ShuffledList
+{
+    std::vector<Node> nodes;
+    Node* head = nullptr;
+
+    ShuffledList(size_t n) : nodes(n)
+    {
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::mt19937_64 rng(123);
+        std::shuffle(order.begin(), order.end(), rng);
+        for (size_t i = 0; i < n; i++)
+        {
+            nodes[order[i]].value = (long long)i;
+            nodes[order[i]].next = (i + 1 < n) ? &nodes[order[i + 1]] : nullptr;
+        }
+        head = n ? &nodes[order[0]] : nullptr;
+    }
+};
+
+
+// ---------- thread pinning ----------
+
+/*/
+On Linux, thread_siblings_list of a cpu tells us which logical cpus share its physical core, e.g. "0,4" or "0-1".
+We return the first two logical cpus of the first core that has a sibling, or -1s if there is no SMT.
+*/
+struct SmtPair { int main = -1, helper = -1; };
+
+SmtPair findSmtSiblings()
+{
+    SmtPair pair;
+#ifdef __linux__
+    unsigned cpus = std::thread::hardware_concurrency();
+    for (unsigned cpu = 0; cpu < cpus; cpu++)
+    {
+        std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list");
+        std::string list;
+        if (!(in >> list)) continue;
+        size_t sep = list.find_first_of(",-");
+        if (sep == std::string::npos) continue; // this core has only one hyperthread
+        pair.main = std::stoi(list.substr(0, sep));
+        pair.helper = (list[sep] == '-') ? pair.main + 1 : std::stoi(list.substr(sep + 1));
+        break;
+    }
+#endif
+    return pair;
+}
+
+bool pinCurrentThread(int cpu)
+{
+#ifdef __linux__
+    if (cpu < 0) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+
+// ---------- run-ahead helper ----------
+
+/*/
+Helper thread shared state. The main thread publishes how far it got, the helper spins while it is more than WINDOW ahead.
+We only use relaxed atomics, helper is a pure performance hint, correctness never depends on it.
+*/
+struct RunAhead
+{
+    std::atomic<size_t> mainPos{ 0 };
+    std::atomic<bool> stop{ false };
+
+    void waitForMain(size_t helperPos)
+    {
+        while (helperPos > mainPos.load(std::memory_order_relaxed) + WINDOW)
+        {
+            if (stop.load(std::memory_order_relaxed)) return;
+            std::this_thread::yield();
+        }
+    }
+};
+
+// touching next is enough, loading it brings the whole node line into the shared cache
+void listHelper(const Node* node, RunAhead& ra, int cpu)
+{
+    pinCurrentThread(cpu);
+    size_t pos = 0;
+    volatile const Node* sink = nullptr;
+    while (node && !ra.stop.load(std::memory_order_relaxed))
+    {
+        ra.waitForMain(pos);
+        node = node->next;
+        sink = node;
+        pos++;
+    }
+    (void)sink;
+}
+
+void randomIndexHelper(ChunkedVector<int>& v, const std::vector<size_t>& indices, RunAhead& ra, int cpu)
+{
+    pinCurrentThread(cpu);
+    for (size_t k = 0; k < indices.size() && !ra.stop.load(std::memory_order_relaxed); k++)
+    {
+        ra.waitForMain(k);
+        prefetch(&v[indices[k]]);
+    }
+}
+
+
+// ---------- linked list benchmarks ----------
+
+enum class Mode { Plain, InLoopPrefetch, HelperThread };
+
+double benchmarkList(ShuffledList& list, Mode mode, const SmtPair& cpus, int repeats = 5)
+{
+    double bestTime = 1e300;
+    for (int r = 0; r < repeats; r++)
+    {
+        RunAhead ra;
+        std::thread helper;
+        if (mode == Mode::HelperThread) helper = std::thread(listHelper, list.head, std::ref(ra), cpus.helper);
+
+        auto start = Clock::now();
+        long long sum = 0;
+        size_t pos = 0;
+        for (const Node* node = list.head; node; node = node->next)
+        {
+            if (mode == Mode::InLoopPrefetch && node->next) prefetch(node->next->next); // best we can do, only one hop ahead
+            sum += node->value;
+            if (mode == Mode::HelperThread && ++pos % PUBLISH_EVERY == 0) ra.mainPos.store(pos, std::memory_order_relaxed);
+        }
+        auto end = Clock::now();
+
+        ra.stop.store(true, std::memory_order_relaxed);
+        if (helper.joinable()) helper.join();
+        std::chrono::duration<double> duration = end - start;
+        bestTime = std::min(bestTime, duration.count());
+        if (sum == 0) std::cout << ""; // dummy read
+    }
+    return bestTime;
+}
+
+
+// ---------- random index benchmarks ----------
+
+double benchmarkRandomIndex(ChunkedVector<int>& v, const std::vector<size_t>& indices, Mode mode, const SmtPair& cpus, int repeats = 5)
+{
+    double bestTime = 1e300;
+    for (int r = 0; r < repeats; r++)
+    {
+        RunAhead ra;
+        std::thread helper;
+        if (mode == Mode::HelperThread) helper = std::thread(randomIndexHelper, std::ref(v), std::cref(indices), std::ref(ra), cpus.helper);
+
+        auto start = Clock::now();
+        long long sum = 0;
+        for (size_t k = 0; k < indices.size(); k++)
+        {
+            if (mode == Mode::InLoopPrefetch && k + PREFETCH_DISTANCE < indices.size()) prefetch(&v[indices[k + PREFETCH_DISTANCE]]);
+            sum += v[indices[k]];
+            if (mode == Mode::HelperThread && (k + 1) % PUBLISH_EVERY == 0) ra.mainPos.store(k + 1, std::memory_order_relaxed);
+        }
+        auto end = Clock::now();
+
+        ra.stop.store(true, std::memory_order_relaxed);
+        if (helper.joinable()) helper.join();
+        std::chrono::duration<double> duration = end - start;
+        bestTime = std::min(bestTime, duration.count());
+        if (sum == 0) std::cout << "";
+    }
+    return bestTime;
+}
+
+
+int main(int argc, char** argv)
+{
+    bool helperMode = false;
+    for (int i = 1; i < argc; i++)
+        if (std::strcmp(argv[i], "--helper") == 0) helperMode = true;
+
+    const size_t N = 4'000'000; // number of list nodes / vector elements / random reads
+
+    SmtPair cpus = findSmtSiblings();
+    if (helperMode)
+    {
+        if (cpus.main < 0)
+            std::cout << "warning: no SMT siblings found, helper thread will run unpinned (results won't mean much)\n";
+        else
+        {
+            pinCurrentThread(cpus.main);
+            std::cout << "main thread on cpu " << cpus.main << ", helper thread on cpu " << cpus.helper << "\n";
+        }
+    }
+
+    ShuffledList list(N);
+    ChunkedVector<int> v;
+    for (size_t k = 0; k < N; k++) v.push_back((int)k);
+    std::vector<size_t> indices(N);
+    std::mt19937_64 rng(321);
+    std::uniform_int_distribution<size_t> dist(0, N - 1);
+    for (auto& index : indices) index = dist(rng);
+
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "Benchmark results (times in seconds)\n\n";
+    std::cout << std::setw(22) << "Workload"
+        << std::setw(12) << "plain"
+        << std::setw(18) << "in-loop prefetch"
+        << std::setw(16) << "helper thread"
+        << "\n";
+
+    double t1 = benchmarkList(list, Mode::Plain, cpus);
+    double t2 = benchmarkList(list, Mode::InLoopPrefetch, cpus);
+    std::cout << std::setw(22) << "linked list" << std::setw(12) << t1 << std::setw(18) << t2;
+    if (helperMode) std::cout << std::setw(16) << benchmarkList(list, Mode::HelperThread, cpus);
+    else std::cout << std::setw(16) << "-";
+    std::cout << "\n";
+
+    t1 = benchmarkRandomIndex(v, indices, Mode::Plain, cpus);
+    t2 = benchmarkRandomIndex(v, indices, Mode::InLoopPrefetch, cpus);
+    std::cout << std::setw(22) << "ChunkedVector random" << std::setw(12) << t1 << std::setw(18) << t2;
+    if (helperMode) std::cout << std::setw(16) << benchmarkRandomIndex(v, indices, Mode::HelperThread, cpus);
+    else std::cout << std::setw(16) << "-";
+    std::cout << "\n";
+
+    if (!helperMode) std::cout << "\nRun with --helper to enable helper-thread prefetching on the SMT sibling.\n";
+    return 0;
+}
@@ -0,0 +1,227 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+Dashboards keep asking the same question, like "sum of mass where x > 0" from the AoS-SoA benchmark,
+and every time we rescan all columns even if only a few rows changed since the last time.
+Instead we register the query once on the table as a view (predicate + aggregate), and every insert, update and erase
+that goes through the table adjusts the view result: subtract the old row's contribution, add the new one.
+That's O(1) per mutation per view, and a query is just reading a number.
+
+Bulk mutations go through updateBatch(), which sums the deltas per view in local variables while it writes the rows,
+and touches the stored view results only once at the end.
+
+Sums are kept in double, adding and subtracting floats can drift a tiny bit over millions of updates, refresh() rescans
+and resets the view if exact values are needed.
+*/
+
+struct Particle
+{
+    float x, y, z, mass;
+};
+
+struct AggregateView
+{
+    bool (*predicate)(const Particle&);
+    double (*value)(const Particle&);
+    double sum = 0;
+    size_t count = 0;
+
+    double contribution(const Particle& p) const { return predicate(p) ? value(p) : 0.0; }
+    size_t matches(const Particle& p) const { return predicate(p) ? 1 : 0; }
+};
+
+class ParticleTable
+{
+    std::vector<float> x, y, z, mass;
+    std::vector<AggregateView> views;
+
+    Particle row(size_t i) const { return { x[i], y[i], z[i], mass[i] }; }
+    void write(size_t i, const Particle& p) { x[i] = p.x, y[i] = p.y, z[i] = p.z, mass[i] = p.mass; }
+
+public:
+    size_t size() const { return x.size(); }
+
+    void reserve(size_t n) { x.reserve(n), y.reserve(n), z.reserve(n), mass.reserve(n); }
+
+    // registers a view and computes its initial value with one full scan, returns its id
+    size_t addView(bool (*predicate)(const Particle&), double (*value)(const Particle&))
+    {
+        views.push_back({ predicate, value });
+        refresh(views.size() - 1);
+        return views.size() - 1;
+    }
+
+    void refresh(size_t view)
+    {
+        AggregateView& v = views[view];
+        v.sum = 0, v.count = 0;
+        for (size_t i = 0; i < size(); i++)
+        {
+            Particle p = row(i);
+            v.sum += v.contribution(p);
+            v.count += v.matches(p);
+        }
+    }
+
+    double sum(size_t view) const { return views[view].sum; }
+    size_t count(size_t view) const { return views[view].count; }
+
+    void insert(const Particle& p)
+    {
+        x.push_back(p.x), y.push_back(p.y), z.push_back(p.z), mass.push_back(p.mass);
+        for (auto& v : views) v.sum += v.contribution(p), v.count += v.matches(p);
+    }
+
+    void update(size_t i, const Particle& p)
+    {
+        Particle old = row(i);
+        for (auto& v : views)
+        {
+            v.sum += v.contribution(p) - v.contribution(old);
+            v.count += v.matches(p) - v.matches(old);
+        }
+        write(i, p);
+    }
+
+    // erase by moving the last row into the hole, row order is not kept
+    void erase(size_t i)
+    {
+        Particle old = row(i);
+        for (auto& v : views) v.sum -= v.contribution(old), v.count -= v.matches(old);
+        write(i, row(size() - 1));
+        x.pop_back(), y.pop_back(), z.pop_back(), mass.pop_back();
+    }
+
+    // rows are written in order, so the same index can appear more than once in a batch
+    void updateBatch(const std::vector<size_t>& indices, const std::vector<Particle>& rows)
+    {
+        std::vector<double> sumDelta(views.size(), 0.0);
+        std::vector<long long> countDelta(views.size(), 0);
+        for (size_t k = 0; k < indices.size(); k++)
+        {
+            Particle old = row(indices[k]);
+            for (size_t v = 0; v < views.size(); v++)
+            {
+                sumDelta[v] += views[v].contribution(rows[k]) - views[v].contribution(old);
+                countDelta[v] += (long long)views[v].matches(rows[k]) - (long long)views[v].matches(old);
+            }
+            write(indices[k], rows[k]);
+        }
+        for (size_t v = 0; v < views.size(); v++)
+        {
+            views[v].sum += sumDelta[v];
+            views[v].count += countDelta[v];
+        }
+    }
+
+    // plain rescan of the same query, what we compare against
+    double scanSum(bool (*predicate)(const Particle&), double (*value)(const Particle&)) const
+    {
+        double s = 0;
+        for (size_t i = 0; i < size(); i++)
+        {
+            Particle p = row(i);
+            if (predicate(p)) s += value(p);
+        }
+        return s;
+    }
+
+    // same as update() but without views, used for the rescan baseline
+    void updateNoViews(size_t i, const Particle& p) { write(i, p); }
+};
+
+
+bool xPositive(const Particle& p) { return p.x > 0.0f; }
+double massOf(const Particle& p) { return p.mass; }
+
+int main()
+{
+    const size_t N = 5'000'000;
+    const std::vector<double> updateRates = { 0.0001, 0.001, 0.01, 0.1 }; // fraction of rows updated between two queries
+
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+
+    ParticleTable table, baseline;
+    table.reserve(N), baseline.reserve(N);
+    for (size_t i = 0; i < N; i++)
+    {
+        Particle p{ dist(rng), dist(rng), dist(rng), dist(rng) };
+        table.insert(p);
+        baseline.insert(p);
+    }
+    size_t view = table.addView(xPositive, massOf);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Incremental aggregate vs full rescan (" << N << " rows, query: sum mass where x > 0)\n\n";
+    std::cout << std::setw(12) << "update rate"
+        << std::setw(18) << "rescan query ms"
+        << std::setw(18) << "view query ms"
+        << std::setw(20) << "update ns (plain)"
+        << std::setw(20) << "update ns (view)"
+        << std::setw(20) << "batch ns (view)"
+        << "\n";
+
+    std::uniform_int_distribution<size_t> pick(0, N - 1);
+    for (double rate : updateRates)
+    {
+        size_t updates = std::max<size_t>(1, size_t(rate * N));
+        std::vector<size_t> indices(updates);
+        std::vector<Particle> rows(updates);
+        for (size_t k = 0; k < updates; k++)
+        {
+            indices[k] = pick(rng);
+            rows[k] = { dist(rng), dist(rng), dist(rng), dist(rng) };
+        }
+
+        auto start = Clock::now();
+        for (size_t k = 0; k < updates; k++) baseline.updateNoViews(indices[k], rows[k]);
+        std::chrono::duration<double, std::nano> plainUpdate = Clock::now() - start;
+
+        start = Clock::now();
+        for (size_t k = 0; k < updates; k++) table.update(indices[k], rows[k]);
+        std::chrono::duration<double, std::nano> viewUpdate = Clock::now() - start;
+
+        // the same kind of mutations again as one batch, mirrored in the baseline so results still match
+        for (size_t k = 0; k < updates; k++) rows[k] = { dist(rng), dist(rng), dist(rng), dist(rng) };
+        for (size_t k = 0; k < updates; k++) baseline.updateNoViews(indices[k], rows[k]);
+        start = Clock::now();
+        table.updateBatch(indices, rows);
+        std::chrono::duration<double, std::nano> batchUpdate = Clock::now() - start;
+
+        // volatile, so the compiler can't move the scan past the second Clock::now()
+        start = Clock::now();
+        volatile double rescan = baseline.scanSum(xPositive, massOf);
+        std::chrono::duration<double, std::milli> rescanQuery = Clock::now() - start;
+
+        start = Clock::now();
+        volatile double incremental = table.sum(view);
+        std::chrono::duration<double, std::milli> viewQuery = Clock::now() - start;
+
+        std::cout << std::setw(11) << rate * 100 << "%"
+            << std::setw(18) << rescanQuery.count()
+            << std::setw(18) << std::setprecision(6) << viewQuery.count() << std::setprecision(3)
+            << std::setw(20) << plainUpdate.count() / updates
+            << std::setw(20) << viewUpdate.count() / updates
+            << std::setw(20) << batchUpdate.count() / updates
+            << "\n";
+        if (std::abs(rescan - incremental) > 1e-6 * std::abs(rescan) + 1.0)
+            std::cout << "  warning: view drifted from rescan (" << incremental << " vs " << rescan << ")\n";
+    }
+
+    // erase and insert go through the view too
+    for (size_t k = 0; k < 1000; k++) table.erase(pick(rng) % table.size());
+    for (size_t k = 0; k < 1000; k++) table.insert({ dist(rng), dist(rng), dist(rng), dist(rng) });
+    double afterChurn = table.sum(view);
+    table.refresh(view);
+    std::cout << "\nafter 1000 erases + 1000 inserts: view " << afterChurn << ", refreshed " << table.sum(view) << "\n";
+    return 0;
+}
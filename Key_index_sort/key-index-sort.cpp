@@ -0,0 +1,246 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+std::sort on std::vector<ParticleAos> with a comparator moves 24-byte structs around O(n log n) times, and for SoA
+there is nothing to call std::sort on at all, you have to sort indices and then reorder every column.
+Key-index sort splits the job in two:
+1. extract (key, index) pairs: the float key is turned into a uint32 that sorts the same way as the float,
+   packed with the 32-bit row index into one uint64
+2. sort the pairs with a parallel LSD radix sort on the 32 key bits (3 passes of 11 bits): every thread builds a
+   histogram of its range, a prefix sum over (digit, thread) gives every thread its own output offsets, and every thread
+   scatters its range. Stable, so equal keys keep their order, like std::stable_sort.
+3. apply the permutation: out[i] = in[perm[i]] in blocks of rows, threads take blocks. The gather reads at random,
+   so we prefetch PREFETCH_DISTANCE rows ahead. For SoA the block of perm stays in L1 while we gather every column
+   for that block, instead of streaming the whole perm array once per column.
+Structs move exactly once, in step 3.
+*/
+
+struct ParticleAos
+{
+    float x, y, z;
+    double mass; // same layout as in AoS-SoA, 24 bytes with padding
+};
+
+struct ParticlesSoA
+{
+    std::vector<float> x, y, z, mass;
+    ParticlesSoA(size_t n)
+    {
+        x.resize(n), y.resize(n), z.resize(n), mass.resize(n);
+    }
+};
+
+constexpr size_t RADIX_BITS = 11;
+constexpr size_t BUCKETS = size_t(1) << RADIX_BITS;
+constexpr size_t BLOCK = 4096;            // rows per permutation block
+constexpr size_t PREFETCH_DISTANCE = 16;
+
+inline void prefetch(const void* p)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p);
+#else
+    (void)p;
+#endif
+}
+
+// float -> uint32 with the same order: flip all bits of negatives, only the sign bit of positives
+inline uint32_t sortableKey(float f)
+{
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u ^ ((u >> 31) ? 0xffffffffu : 0x80000000u);
+}
+
+template<typename F>
+void parallelFor(unsigned threads, F f)
+{
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; t++) workers.emplace_back(f, t);
+    f(0u);
+    for (auto& w : workers) w.join();
+}
+
+// sorts pairs by their upper 32 bits, stable
+void parallelRadixSort(std::vector<uint64_t>& pairs, unsigned threads)
+{
+    size_t n = pairs.size();
+    std::vector<uint64_t> buffer(n);
+    std::vector<std::vector<size_t>> offsets(threads, std::vector<size_t>(BUCKETS));
+    uint64_t* from = pairs.data();
+    uint64_t* to = buffer.data();
+    auto rangeOf = [&](unsigned t) { return std::make_pair(n * t / threads, n * (t + 1) / threads); };
+
+    for (size_t shift = 32; shift < 64; shift += RADIX_BITS)
+    {
+        parallelFor(threads, [&](unsigned t) {
+            auto range = rangeOf(t);
+            std::vector<size_t>& count = offsets[t];
+            std::fill(count.begin(), count.end(), 0);
+            for (size_t i = range.first; i < range.second; i++) count[(from[i] >> shift) & (BUCKETS - 1)]++;
+        });
+        size_t sum = 0;
+        for (size_t d = 0; d < BUCKETS; d++) // digit-major, so thread t's keys go after thread t-1's for the same digit
+            for (unsigned t = 0; t < threads; t++)
+            {
+                size_t c = offsets[t][d];
+                offsets[t][d] = sum;
+                sum += c;
+            }
+        parallelFor(threads, [&](unsigned t) {
+            auto range = rangeOf(t);
+            std::vector<size_t>& offset = offsets[t];
+            for (size_t i = range.first; i < range.second; i++) to[offset[(from[i] >> shift) & (BUCKETS - 1)]++] = from[i];
+        });
+        std::swap(from, to);
+    }
+    if (from != pairs.data()) std::copy(from, from + n, pairs.data()); // odd number of passes
+}
+
+template<typename T>
+inline void gatherBlock(const T* in, T* out, const uint32_t* perm, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        if (i + PREFETCH_DISTANCE < end) prefetch(&in[perm[i + PREFETCH_DISTANCE]]);
+        out[i] = in[perm[i]];
+    }
+}
+
+std::vector<uint32_t> sortedPermutation(const float* keys, size_t n, unsigned threads)
+{
+    std::vector<uint64_t> pairs(n);
+    parallelFor(threads, [&](unsigned t) {
+        for (size_t i = n * t / threads; i < n * (t + 1) / threads; i++) pairs[i] = uint64_t(sortableKey(keys[i])) << 32 | uint32_t(i);
+    });
+    parallelRadixSort(pairs, threads);
+    std::vector<uint32_t> perm(n);
+    parallelFor(threads, [&](unsigned t) {
+        for (size_t i = n * t / threads; i < n * (t + 1) / threads; i++) perm[i] = uint32_t(pairs[i]);
+    });
+    return perm;
+}
+
+void keyIndexSortAoS(std::vector<ParticleAos>& particles, unsigned threads)
+{
+    size_t n = particles.size();
+    std::vector<float> keys(n);
+    for (size_t i = 0; i < n; i++) keys[i] = particles[i].x;
+    std::vector<uint32_t> perm = sortedPermutation(keys.data(), n, threads);
+    std::vector<ParticleAos> out(n);
+    size_t blocks = (n + BLOCK - 1) / BLOCK;
+    parallelFor(threads, [&](unsigned t) {
+        for (size_t b = t; b < blocks; b += threads)
+            gatherBlock(particles.data(), out.data(), perm.data(), b * BLOCK, std::min(n, (b + 1) * BLOCK));
+    });
+    particles.swap(out);
+}
+
+void keyIndexSortSoA(ParticlesSoA& p, unsigned threads)
+{
+    size_t n = p.x.size();
+    std::vector<uint32_t> perm = sortedPermutation(p.x.data(), n, threads);
+    ParticlesSoA out(n);
+    size_t blocks = (n + BLOCK - 1) / BLOCK;
+    parallelFor(threads, [&](unsigned t) {
+        for (size_t b = t; b < blocks; b += threads)
+        {
+            size_t begin = b * BLOCK, end = std::min(n, (b + 1) * BLOCK);
+            gatherBlock(p.x.data(), out.x.data(), perm.data(), begin, end); // perm block is in L1 for the next 3 columns
+            gatherBlock(p.y.data(), out.y.data(), perm.data(), begin, end);
+            gatherBlock(p.z.data(), out.z.data(), perm.data(), begin, end);
+            gatherBlock(p.mass.data(), out.mass.data(), perm.data(), begin, end);
+        }
+    });
+    std::swap(p, out);
+}
+
+// baseline for SoA: std::sort of indices with a comparator, then every column reordered one after another
+void stdSortSoA(ParticlesSoA& p)
+{
+    size_t n = p.x.size();
+    std::vector<uint32_t> perm(n);
+    for (size_t i = 0; i < n; i++) perm[i] = uint32_t(i);
+    std::sort(perm.begin(), perm.end(), [&](uint32_t a, uint32_t b) { return p.x[a] < p.x[b]; });
+    ParticlesSoA out(n);
+    for (size_t i = 0; i < n; i++) out.x[i] = p.x[perm[i]];
+    for (size_t i = 0; i < n; i++) out.y[i] = p.y[perm[i]];
+    for (size_t i = 0; i < n; i++) out.z[i] = p.z[perm[i]];
+    for (size_t i = 0; i < n; i++) out.mass[i] = p.mass[perm[i]];
+    std::swap(p, out);
+}
+
+template<typename F>
+double timeMs(F f)
+{
+    auto start = Clock::now();
+    f();
+    std::chrono::duration<double, std::milli> duration = Clock::now() - start;
+    return duration.count();
+}
+
+int main(int argc, char** argv)
+{
+    // 100M needs about 8 GB (AoS copy + pairs + SoA copy), so it's opt-in: ./keysort 100000000
+    size_t maxN = argc > 1 ? std::stoull(argv[1]) : 10'000'000;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Sort particles by x, " << threads << " thread(s) for the key-index sort (ms)\n\n";
+    std::cout << std::setw(12) << "n"
+        << std::setw(16) << "std::sort AoS"
+        << std::setw(16) << "key-index AoS"
+        << std::setw(16) << "std::sort SoA"
+        << std::setw(16) << "key-index SoA"
+        << "\n";
+
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    for (size_t n : { size_t(1'000'000), size_t(10'000'000), size_t(100'000'000) })
+    {
+        if (n > maxN) break;
+        std::vector<ParticleAos> original(n);
+        for (auto& p : original) p = { dist(rng), dist(rng), dist(rng), double(dist(rng)) };
+
+        std::vector<ParticleAos> a = original, b = original;
+        double stdAos = timeMs([&] { std::sort(a.begin(), a.end(), [](const ParticleAos& l, const ParticleAos& r) { return l.x < r.x; }); });
+        double keyAos = timeMs([&] { keyIndexSortAoS(b, threads); });
+        for (size_t i = 0; i < n; i++)
+            if (a[i].x != b[i].x) { std::cout << "  warning: AoS results differ at " << i << "\n"; break; }
+        a.clear(), a.shrink_to_fit(), b.clear(), b.shrink_to_fit();
+
+        double stdSoa, keySoa;
+        {
+            ParticlesSoA s(n), k(n);
+            for (size_t i = 0; i < n; i++)
+            {
+                s.x[i] = k.x[i] = original[i].x, s.y[i] = k.y[i] = original[i].y;
+                s.z[i] = k.z[i] = original[i].z, s.mass[i] = k.mass[i] = float(original[i].mass);
+            }
+            original.clear(), original.shrink_to_fit();
+            stdSoa = timeMs([&] { stdSortSoA(s); });
+            keySoa = timeMs([&] { keyIndexSortSoA(k, threads); });
+            if (!std::is_sorted(k.x.begin(), k.x.end()) || s.x != k.x) std::cout << "  warning: SoA results differ\n";
+        }
+
+        std::cout << std::setw(12) << n
+            << std::setw(16) << stdAos
+            << std::setw(16) << keyAos
+            << std::setw(16) << stdSoa
+            << std::setw(16) << keySoa
+            << "\n";
+    }
+    if (maxN < 100'000'000) std::cout << "\n(run with 100000000 as argument to include 100M elements)\n";
+    return 0;
+}
@@ -0,0 +1,386 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <type_traits>
+#include <algorithm>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+Looking at the struct alone we can't tell which fields are hot, that depends on what the program does with them.
+Here the AoS and SoA containers get an opt-in proxy mode (PROFILE = true): operator[] hands out small proxy objects instead of
+plain references, and every read or write through a proxy is counted per field.
+We also look at the index order (is this field walked sequentially or hit at random) and which fields are touched
+together on the same element, and from that we print a recommended layout.
+With PROFILE = false the containers are plain vectors/structs, so normal runs pay nothing.
+*/
+
+enum Field { X, Y, Z, MASS, FIELD_COUNT };
+const char* fieldNames[FIELD_COUNT] = { "x", "y", "z", "mass" };
+
+struct ParticleAos
+{
+    float x, y, z;
+    double mass; // same layout as in AoS-SoA benchmark, 4 bytes of padding after z
+};
+
+const size_t fieldSizes[FIELD_COUNT] = { sizeof(float), sizeof(float), sizeof(float), sizeof(double) };
+
+
+// ---------- profiler ----------
+
+class FieldProfiler
+{
+public:
+    struct FieldStats
+    {
+        size_t reads = 0, writes = 0;
+        size_t sequential = 0, random = 0;
+        size_t visits = 0; // number of distinct element visits where this field was touched
+        size_t lastIndex = SIZE_MAX;
+    };
+
+    FieldStats fields[FIELD_COUNT];
+    size_t coAccess[FIELD_COUNT][FIELD_COUNT] = {}; // how many element visits touched both fields
+    size_t maskVisits[1 << FIELD_COUNT] = {};         // how many element visits touched exactly this set of fields
+
+    void record(Field f, size_t index, bool write)
+    {
+        FieldStats& s = fields[f];
+        (write ? s.writes : s.reads)++;
+        if (s.lastIndex != SIZE_MAX && s.lastIndex != index)
+            (index == s.lastIndex + 1 ? s.sequential : s.random)++;
+        s.lastIndex = index;
+
+        // all field accesses with the same index in a row belong to one element visit
+        if (index != currentIndex) flushVisit();
+        currentIndex = index;
+        currentMask |= 1u << f;
+    }
+
+    // closes the last element visit, call before reading the stats
+    void flushVisit()
+    {
+        if (currentMask) maskVisits[currentMask]++;
+        for (int a = 0; a < FIELD_COUNT; a++)
+        {
+            if (!(currentMask & (1u << a))) continue;
+            fields[a].visits++;
+            for (int b = 0; b < FIELD_COUNT; b++)
+                if (currentMask & (1u << b)) coAccess[a][b]++;
+        }
+        currentMask = 0;
+        currentIndex = SIZE_MAX;
+    }
+
+    void report(size_t elementCount);
+
+private:
+    size_t currentIndex = SIZE_MAX;
+    unsigned currentMask = 0;
+};
+
+
+// ---------- proxies ----------
+
+template<typename T>
+class FieldRef
+{
+    T& value;
+    FieldProfiler* profiler;
+    Field field;
+    size_t index;
+
+public:
+    FieldRef(T& value, FieldProfiler* profiler, Field field, size_t index) : value(value), profiler(profiler), field(field), index(index) {}
+
+    operator T() const { profiler->record(field, index, false); return value; }
+    FieldRef& operator=(T v) { profiler->record(field, index, true); value = v; return *this; }
+    FieldRef& operator+=(T v) { profiler->record(field, index, false); profiler->record(field, index, true); value += v; return *this; }
+};
+
+template<typename T>
+class ProfiledColumn
+{
+    std::vector<T> data;
+    FieldProfiler* profiler = nullptr;
+    Field field = X;
+
+public:
+    void attach(FieldProfiler* p, Field f) { profiler = p; field = f; }
+    void resize(size_t n) { data.resize(n); }
+    std::vector<T>& raw() { return data; } // unprofiled access, used for initialization
+    size_t size() const { return data.size(); }
+    FieldRef<T> operator[](size_t index) { return FieldRef<T>(data[index], profiler, field, index); }
+};
+
+template<bool PROFILE>
+struct ParticlesSoA
+{
+    template<typename T>
+    using Column = std::conditional_t<PROFILE, ProfiledColumn<T>, std::vector<T>>;
+
+    Column<float> x, y, z, mass;
+    ParticlesSoA(size_t n, FieldProfiler* profiler = nullptr)
+    {
+        x.resize(n), y.resize(n), z.resize(n), mass.resize(n);
+        std::mt19937_64 rng(123);
+        std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+        for (size_t i = 0; i < n; i++)
+        {
+            raw<float>(x)[i] = dist(rng);
+            raw<float>(y)[i] = dist(rng);
+            raw<float>(z)[i] = dist(rng);
+            raw<float>(mass)[i] = dist(rng);
+        }
+        if constexpr (PROFILE)
+        {
+            x.attach(profiler, X), y.attach(profiler, Y), z.attach(profiler, Z), mass.attach(profiler, MASS);
+        }
+        (void)profiler;
+    }
+
+    template<typename T>
+    static std::vector<T>& raw(Column<T>& column)
+    {
+        if constexpr (PROFILE) return column.raw();
+        else return column;
+    }
+    size_t size() const { return x.size(); }
+};
+
+struct ParticleProxy
+{
+    FieldRef<float> x, y, z;
+    FieldRef<double> mass;
+};
+
+template<bool PROFILE>
+class ParticlesAoS
+{
+    std::vector<ParticleAos> data;
+    FieldProfiler* profiler;
+
+public:
+    ParticlesAoS(size_t n, FieldProfiler* profiler = nullptr) : profiler(profiler)
+    {
+        data.reserve(n);
+        std::mt19937_64 rng(123);
+        std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+        for (size_t i = 0; i < n; i++) data.push_back({ dist(rng), dist(rng), dist(rng), dist(rng) });
+    }
+    size_t size() const { return data.size(); }
+
+    decltype(auto) operator[](size_t i)
+    {
+        if constexpr (PROFILE)
+            return ParticleProxy{ { data[i].x, profiler, X, i }, { data[i].y, profiler, Y, i },
+                                  { data[i].z, profiler, Z, i }, { data[i].mass, profiler, MASS, i } };
+        else
+            return (data[i]);
+    }
+};
+
+
+// ---------- recommendation ----------
+
+/*/
+Heuristic:
+- fields touched in less than 10% of the visits of the hottest field are cold, they go to a separate cold array
+- hot fields are grouped when they are touched together in at least half of their visits (co-access affinity)
+- if every hot field ends up in one group and access is mostly random -> AoS (one cache line per object)
+- if every group is a single field -> SoA
+- otherwise -> AoSoA groups, each group stored as a small struct in its own array
+Bytes estimate: every element visit has to bring in every structure that holds one of the touched fields,
+so with AoS a visit costs sizeof(ParticleAos), with the recommended layout only the sizes of the touched groups.
+We sum that over all recorded visits and scale it to one pass over elementCount elements.
+*/
+void FieldProfiler::report(size_t elementCount)
+{
+    flushVisit();
+    size_t hottest = 0;
+    for (auto& f : fields) hottest = std::max(hottest, f.visits);
+
+    std::cout << std::setw(8) << "field" << std::setw(12) << "reads" << std::setw(12) << "writes"
+        << std::setw(14) << "sequential" << std::setw(12) << "random" << "\n";
+    for (int f = 0; f < FIELD_COUNT; f++)
+        std::cout << std::setw(8) << fieldNames[f] << std::setw(12) << fields[f].reads << std::setw(12) << fields[f].writes
+            << std::setw(14) << fields[f].sequential << std::setw(12) << fields[f].random << "\n";
+
+    std::cout << "\nco-access affinity (visits with both / visits of the more used field)\n" << std::setw(8) << "";
+    for (int b = 0; b < FIELD_COUNT; b++) std::cout << std::setw(8) << fieldNames[b];
+    std::cout << "\n";
+    auto affinity = [&](int a, int b) {
+        size_t denom = std::max(fields[a].visits, fields[b].visits);
+        return denom ? double(coAccess[a][b]) / double(denom) : 0.0;
+    };
+    for (int a = 0; a < FIELD_COUNT; a++)
+    {
+        std::cout << std::setw(8) << fieldNames[a];
+        for (int b = 0; b < FIELD_COUNT; b++) std::cout << std::setw(8) << affinity(a, b);
+        std::cout << "\n";
+    }
+
+    // group hot fields with union-find over pairs with high affinity
+    int group[FIELD_COUNT];
+    for (int f = 0; f < FIELD_COUNT; f++) group[f] = f;
+    auto find = [&](int f) { while (group[f] != f) f = group[f]; return f; };
+    std::vector<int> hot, cold;
+    for (int f = 0; f < FIELD_COUNT; f++)
+        (fields[f].visits * 10 >= hottest && fields[f].visits > 0 ? hot : cold).push_back(f);
+    for (int a : hot)
+        for (int b : hot)
+            if (a < b && affinity(a, b) >= 0.5) group[find(b)] = find(a);
+
+    std::vector<std::vector<int>> groups;
+    for (int f : hot)
+    {
+        int root = find(f);
+        auto it = std::find_if(groups.begin(), groups.end(), [&](auto& g) { return find(g.front()) == root; });
+        if (it == groups.end()) groups.push_back({ f });
+        else it->push_back(f);
+    }
+
+    size_t sequential = 0, random = 0;
+    for (int f : hot) sequential += fields[f].sequential, random += fields[f].random;
+
+    std::string layout;
+    if (groups.size() == 1 && random > sequential) layout = "AoS";
+    else if (std::all_of(groups.begin(), groups.end(), [](auto& g) { return g.size() == 1; })) layout = "SoA";
+    else layout = "AoSoA groups";
+    if (!cold.empty()) layout += " + hot/cold split";
+
+    std::cout << "\nrecommended layout: " << layout << "\n";
+    for (auto& g : groups)
+    {
+        std::cout << "  hot group {";
+        for (size_t i = 0; i < g.size(); i++) std::cout << (i ? ", " : " ") << fieldNames[g[i]];
+        std::cout << " }\n";
+    }
+    if (!cold.empty())
+    {
+        std::cout << "  cold {";
+        for (size_t i = 0; i < cold.size(); i++) std::cout << (i ? ", " : " ") << fieldNames[cold[i]];
+        std::cout << " }\n";
+    }
+
+    if (!cold.empty()) groups.push_back(cold); // cold fields are stored together, they still cost bytes when touched
+    double aosBytes = 0, recommendedBytes = 0, visits = 0;
+    for (unsigned mask = 1; mask < (1u << FIELD_COUNT); mask++)
+    {
+        if (!maskVisits[mask]) continue;
+        visits += maskVisits[mask];
+        aosBytes += double(maskVisits[mask]) * sizeof(ParticleAos);
+        for (auto& g : groups)
+        {
+            bool touched = std::any_of(g.begin(), g.end(), [&](int f) { return mask & (1u << f); });
+            size_t groupBytes = 0;
+            for (int f : g) groupBytes += fieldSizes[f];
+            if (touched) recommendedBytes += double(maskVisits[mask]) * groupBytes;
+        }
+    }
+    double perPass = visits ? double(elementCount) / visits : 0.0;
+    std::cout << "estimated bytes per pass over " << elementCount << " elements: AoS " << aosBytes * perPass
+        << ", recommended " << recommendedBytes * perPass << ", saved " << (aosBytes - recommendedBytes) * perPass << "\n";
+}
+
+
+// ---------- workload ----------
+
+/*/
+Same kernel as in AoS-SoA (x > 0 -> sum mass), plus an object-centric phase that moves random particles (x, y, z together).
+Templated on PROFILE, so exactly the same code runs with and without profiling.
+*/
+template<bool PROFILE>
+double runWorkload(ParticlesAoS<PROFILE>& particles, size_t randomUpdates)
+{
+    size_t n = particles.size();
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+
+    double sum = 0;
+    for (size_t k = 0; k < n; k++)
+    {
+        if (particles[k].x > 0.0f) sum += particles[k].mass;
+    }
+    for (size_t u = 0; u < randomUpdates; u++)
+    {
+        size_t i = pick(rng);
+        particles[i].x += dist(rng) * 0.01f;
+        particles[i].y += dist(rng) * 0.01f;
+        particles[i].z += dist(rng) * 0.01f;
+    }
+    return sum;
+}
+
+template<bool PROFILE>
+double runWorkload(ParticlesSoA<PROFILE>& particles, size_t randomUpdates)
+{
+    size_t n = particles.size();
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+
+    double sum = 0;
+    for (size_t k = 0; k < n; k++)
+    {
+        if (particles.x[k] > 0.0f) sum += particles.mass[k];
+    }
+    for (size_t u = 0; u < randomUpdates; u++)
+    {
+        size_t i = pick(rng);
+        particles.x[i] += dist(rng) * 0.01f;
+        particles.y[i] += dist(rng) * 0.01f;
+        particles.z[i] += dist(rng) * 0.01f;
+    }
+    return sum;
+}
+
+int main(int argc, char** argv)
+{
+    bool profile = false;
+    for (int i = 1; i < argc; i++)
+        if (std::strcmp(argv[i], "--profile") == 0) profile = true;
+
+    const size_t N = 1'000'000;
+    const size_t RANDOM_UPDATES = N / 2;
+
+    if (!profile)
+    {
+        ParticlesAoS<false> aos(N);
+        auto start = Clock::now();
+        double sum = runWorkload(aos, RANDOM_UPDATES);
+        std::chrono::duration<double> duration = Clock::now() - start;
+        std::cout << "AoS workload time: " << duration.count() << " s\n";
+        ParticlesSoA<false> soa(N);
+        start = Clock::now();
+        sum += runWorkload(soa, RANDOM_UPDATES);
+        duration = Clock::now() - start;
+        std::cout << "SoA workload time: " << duration.count() << " s\n";
+        if (sum == 0) std::cout << "";
+        std::cout << "Run with --profile to count field accesses and get a layout recommendation.\n";
+        return 0;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    {
+        FieldProfiler profiler;
+        ParticlesAoS<true> particles(N, &profiler);
+        runWorkload(particles, RANDOM_UPDATES);
+        std::cout << "Field access profile (AoS container, " << N << " particles)\n\n";
+        profiler.report(N);
+    }
+    {
+        FieldProfiler profiler;
+        ParticlesSoA<true> particles(N, &profiler);
+        runWorkload(particles, RANDOM_UPDATES);
+        std::cout << "\nField access profile (SoA container, " << N << " particles)\n\n";
+        profiler.report(N);
+    }
+    return 0;
+}
@@ -0,0 +1,283 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+PoolAllocator::allocate calls new T[capacity] when its buffer is full, and that can take anything from nanoseconds
+to milliseconds (page faults, the allocator's own locks, mmap). A real-time thread can't have that on its hot path.
+LockFreeBlockPool allocates all its blocks once in the constructor and never calls the system allocator again:
+- free blocks form a Treiber stack (lock-free LIFO). The head is one 64-bit atomic: 32-bit block index + 32-bit tag.
+  The tag is incremented by every successful CAS, so a head that was popped and pushed back in between (ABA) fails the CAS.
+- next links are block indices in a separate array, so a block's memory is never touched by the free list
+- allocate and free are one CAS each when there is no contention. Under contention a CAS can fail and retry, that is
+  lock-free, not wait-free, but no thread can be stalled by another thread that got preempted while holding a lock.
+- an empty pool returns nullptr instead of growing
+ThreadCache is an optional per-thread stash of up to CACHE blocks in front of the stack: most allocations and frees don't
+touch the shared head at all, a refill pops at most CACHE/2 blocks and a flush pushes CACHE/2, so the worst case is bounded.
+*/
+
+template<typename T>
+class LockFreeBlockPool
+{
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    std::unique_ptr<T[]> blocks;
+    std::unique_ptr<std::atomic<uint32_t>[]> next;
+    std::atomic<uint64_t> head; // index in the low 32 bits, tag in the high 32
+    uint32_t count;
+
+    static uint64_t pack(uint32_t index, uint32_t tag) { return uint64_t(tag) << 32 | index; }
+    static uint32_t indexOf(uint64_t h) { return uint32_t(h); }
+    static uint32_t tagOf(uint64_t h) { return uint32_t(h >> 32); }
+
+public:
+    LockFreeBlockPool(uint32_t count) : blocks(new T[count]), next(new std::atomic<uint32_t>[count]), count(count)
+    {
+        for (uint32_t i = 0; i < count; i++) next[i].store(i + 1 < count ? i + 1 : NIL, std::memory_order_relaxed);
+        head.store(pack(count ? 0 : NIL, 0), std::memory_order_release);
+    }
+
+    T* allocate()
+    {
+        uint64_t old = head.load(std::memory_order_acquire);
+        while (true)
+        {
+            uint32_t index = indexOf(old);
+            if (index == NIL) return nullptr; // exhausted, we never grow
+            uint64_t desired = pack(next[index].load(std::memory_order_relaxed), tagOf(old) + 1);
+            if (head.compare_exchange_weak(old, desired, std::memory_order_acquire, std::memory_order_acquire))
+                return &blocks[index];
+        }
+    }
+
+    void deallocate(T* block)
+    {
+        uint32_t index = uint32_t(block - blocks.get());
+        uint64_t old = head.load(std::memory_order_relaxed);
+        while (true)
+        {
+            next[index].store(indexOf(old), std::memory_order_relaxed);
+            if (head.compare_exchange_weak(old, pack(index, tagOf(old) + 1), std::memory_order_release, std::memory_order_relaxed))
+                return;
+        }
+    }
+
+    uint32_t capacity() const { return count; }
+};
+
+// per-thread front cache, one per worker, not shared
+template<typename T, size_t CACHE = 32>
+class ThreadCache
+{
+    LockFreeBlockPool<T>& pool;
+    T* stash[CACHE];
+    size_t size = 0;
+
+public:
+    ThreadCache(LockFreeBlockPool<T>& pool) : pool(pool) {}
+    ~ThreadCache() { while (size) pool.deallocate(stash[--size]); }
+
+    T* allocate()
+    {
+        if (!size)
+            for (size_t k = 0; k < CACHE / 2; k++) // bounded refill
+            {
+                T* block = pool.allocate();
+                if (!block) break;
+                stash[size++] = block;
+            }
+        return size ? stash[--size] : nullptr;
+    }
+
+    void deallocate(T* block)
+    {
+        if (size == CACHE)
+            for (size_t k = 0; k < CACHE / 2; k++) pool.deallocate(stash[--size]); // bounded flush
+        stash[size++] = block;
+    }
+};
+
+
+// baselines
+
+// PoolAllocator from Vector_allocation_benhmarks, one per thread (it isn't thread safe) and it never reuses memory
+template<typename T>
+class PoolAllocator
+{
+    std::vector<T*> buffers;
+    size_t capacity;
+    size_t offset;
+public:
+    PoolAllocator(size_t cap) : capacity(cap), offset(0) {
+        buffers.push_back(new T[cap]);
+    }
+
+    T* allocate(size_t n) {
+        if (offset + n > capacity)
+        {
+            buffers.push_back(new T[capacity]);
+            offset = 0;
+        }
+        T* ptr = buffers.back() + offset;
+        offset += n;
+        return ptr;
+    }
+
+    ~PoolAllocator() {
+        for (auto buffer : buffers) delete[] buffer;
+    }
+};
+
+// free list behind a mutex
+template<typename T>
+class MutexBlockPool
+{
+    std::unique_ptr<T[]> blocks;
+    std::vector<T*> freeList;
+    std::mutex mutex;
+
+public:
+    MutexBlockPool(uint32_t count) : blocks(new T[count])
+    {
+        freeList.reserve(count);
+        for (uint32_t i = 0; i < count; i++) freeList.push_back(&blocks[i]);
+    }
+
+    T* allocate()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeList.empty()) return nullptr;
+        T* block = freeList.back();
+        freeList.pop_back();
+        return block;
+    }
+
+    void deallocate(T* block)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeList.push_back(block);
+    }
+};
+
+
+struct Block
+{
+    float data[16]; // 64 bytes, e.g. a small particle batch
+};
+
+enum Mode { NewDelete, PerThreadPoolAllocator, MutexPool, LockFree, LockFreeCached };
+const char* modeNames[] = { "new/delete", "PoolAllocator", "mutex free list", "lock-free", "lock-free + cache" };
+
+struct LatencyReport
+{
+    double mopsPerSecond;
+    uint64_t p50, p99, p9999, worst;
+};
+
+// every thread keeps HOLD blocks alive in a ring: free the oldest, allocate a new one, write to it.
+// Each allocate and each free is timed on its own.
+LatencyReport runMode(Mode mode, unsigned threads, size_t opsPerThread)
+{
+    const size_t HOLD = 64;
+    LockFreeBlockPool<Block> lockFree(uint32_t(threads * (HOLD + 64)));
+    MutexBlockPool<Block> mutexPool(uint32_t(threads * (HOLD + 64)));
+    std::vector<std::vector<uint32_t>> latencies(threads);
+
+    auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++)
+        workers.emplace_back([&, t] {
+            std::vector<uint32_t>& samples = latencies[t];
+            samples.reserve(2 * opsPerThread);
+            PoolAllocator<Block> bump(1024);
+            ThreadCache<Block> cache(lockFree);
+            Block* ring[HOLD] = {};
+
+            auto allocate = [&]() -> Block* {
+                switch (mode)
+                {
+                case NewDelete: return new Block;
+                case PerThreadPoolAllocator: return bump.allocate(1);
+                case MutexPool: return mutexPool.allocate();
+                case LockFree: return lockFree.allocate();
+                default: return cache.allocate();
+                }
+            };
+            auto deallocate = [&](Block* b) {
+                switch (mode)
+                {
+                case NewDelete: delete b; break;
+                case PerThreadPoolAllocator: break; // bump allocator can't free single blocks
+                case MutexPool: mutexPool.deallocate(b); break;
+                case LockFree: lockFree.deallocate(b); break;
+                default: cache.deallocate(b); break;
+                }
+            };
+
+            for (size_t op = 0; op < opsPerThread; op++)
+            {
+                Block*& slot = ring[op % HOLD];
+                if (slot)
+                {
+                    auto t0 = Clock::now();
+                    deallocate(slot);
+                    samples.push_back(uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count()));
+                }
+                auto t0 = Clock::now();
+                slot = allocate();
+                samples.push_back(uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count()));
+                if (slot) slot->data[0] = float(op);
+            }
+            for (Block* b : ring)
+                if (b) deallocate(b);
+        });
+    for (auto& w : workers) w.join();
+    std::chrono::duration<double> duration = Clock::now() - start;
+
+    std::vector<uint32_t> all;
+    for (auto& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+    auto at = [&](double q) { return uint64_t(all[std::min(all.size() - 1, size_t(q * double(all.size())))]); };
+    return { double(all.size()) / duration.count() / 1e6, at(0.5), at(0.99), at(0.9999), all.back() };
+}
+
+int main()
+{
+    const size_t OPS_PER_THREAD = 1'000'000;
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "Block allocation latency (64-byte blocks, 64 live blocks per thread, every allocate/free timed, ns)\n";
+    std::cout << "hardware threads: " << hw << ", with more threads than cores preemption shows up in the worst case too\n";
+    for (unsigned threads : { 1u, std::max(2u, hw), 2 * std::max(2u, hw) })
+    {
+        std::cout << "\n" << threads << " thread(s)\n";
+        std::cout << std::setw(20) << "allocator"
+            << std::setw(12) << "Mops/s"
+            << std::setw(10) << "p50"
+            << std::setw(10) << "p99"
+            << std::setw(12) << "p99.99"
+            << std::setw(12) << "worst"
+            << "\n";
+        for (Mode mode : { NewDelete, PerThreadPoolAllocator, MutexPool, LockFree, LockFreeCached })
+        {
+            LatencyReport r = runMode(mode, threads, OPS_PER_THREAD);
+            std::cout << std::setw(20) << modeNames[mode]
+                << std::setw(12) << std::fixed << std::setprecision(2) << r.mopsPerSecond
+                << std::setw(10) << r.p50
+                << std::setw(10) << r.p99
+                << std::setw(12) << r.p9999
+                << std::setw(12) << r.worst
+                << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,290 @@
+#include <iostream>
+#include <vector>
+#include <climits>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+ChunkedVector<int> spends 32 bits on every value, even when the values in a chunk only need 5 or 12 bits.
+PackedChunkedVector keeps the tail chunk as plain ints (so push_back stays cheap), and when the chunk is full it gets
+"sealed": we take the chunk's minimum as base (frame of reference) and store value - base in just as many bits as the
+largest difference needs. Sequential ids 0, 1, 2... need only log2(CHUNK_SIZE) bits per value like this.
+- random access: chunk directory -> bit offset -> read 2 words, shift, mask, add base. No branches.
+- scans: a whole chunk is unpacked into a small buffer first, with an unpack loop instantiated for every bit width
+  (0..32), so the bit width is a compile-time constant and the compiler can unroll and vectorize it (-O3 -march=native).
+Every sealed chunk gets one extra padding word, so reading "2 words" never goes past the end.
+*/
+
+//CHUNKED VECTOR WITH NEW[] (same as in Vector_allocation_benhmarks)
+template<typename T, size_t CHUNK_SIZE = 64>
+class ChunkedVector {
+    std::vector<T*> chunks;
+    size_t size = 0;
+
+public:
+    ~ChunkedVector() {
+        for (auto chunk : chunks) delete[] chunk;
+    }
+
+    void push_back(const T& value) {
+        if (size % CHUNK_SIZE == 0)
+            chunks.push_back(new T[CHUNK_SIZE]);
+        chunks[size / CHUNK_SIZE][size % CHUNK_SIZE] = value;
+        size++;
+    }
+
+    T& operator[](size_t index) {
+        return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+
+    size_t get_size() const { return size; }
+    size_t bytes() const { return chunks.size() * (CHUNK_SIZE * sizeof(T) + sizeof(T*)); }
+};
+
+
+template<size_t CHUNK_SIZE = 1024>
+class PackedChunkedVector
+{
+    static_assert(CHUNK_SIZE % 64 == 0, "unpack works on groups of 64 values");
+
+    struct ChunkEntry
+    {
+        int base;           // smallest value in the chunk
+        uint32_t bits;      // bits per value, 0 if all values are equal
+        size_t wordOffset;  // first word of the chunk in words
+    };
+
+    std::vector<ChunkEntry> directory; // sealed chunks only
+    std::vector<uint64_t> words;
+    int tail[CHUNK_SIZE];
+    size_t tailSize = 0;
+
+    template<uint32_t BITS>
+    static void unpack(const uint64_t* in, int base, int* out)
+    {
+        if (BITS == 0) // constant chunk, its only word is padding, nothing to read
+        {
+            std::fill(out, out + CHUNK_SIZE, base);
+            return;
+        }
+        const uint64_t mask = BITS == 0 ? 0 : (~0ull >> (64 - BITS));
+        // 64 values take exactly BITS words, so inside a group every shift is a constant after unrolling
+        for (size_t group = 0; group < CHUNK_SIZE / 64; group++, in += BITS, out += 64)
+        {
+            for (size_t j = 0; j < 64; j++)
+            {
+                size_t bit = j * BITS;
+                size_t w = bit / 64, shift = bit % 64;
+                // (hi << 1) << (63 - shift) instead of hi << (64 - shift), shift by 64 is undefined
+                uint64_t raw = (in[w] >> shift) | ((in[w + 1] << 1) << (63 - shift));
+                out[j] = int(uint32_t(base) + uint32_t(raw & mask)); // unsigned add, the delta can be above INT_MAX
+            }
+        }
+    }
+
+    using Unpacker = void (*)(const uint64_t*, int, int*);
+
+    template<size_t... B>
+    static const Unpacker* makeUnpackers(std::index_sequence<B...>)
+    {
+        static const Unpacker table[] = { &unpack<uint32_t(B)>... };
+        return table;
+    }
+
+    static const Unpacker* unpackers() { return makeUnpackers(std::make_index_sequence<33>()); }
+
+    void seal()
+    {
+        int lo = *std::min_element(tail, tail + CHUNK_SIZE);
+        int hi = *std::max_element(tail, tail + CHUNK_SIZE);
+        uint32_t range = uint32_t(hi) - uint32_t(lo);
+        uint32_t bits = 0;
+        while (bits < 32 && (range >> bits)) bits++;
+
+        size_t offset = words.size();
+        words.resize(offset + (CHUNK_SIZE * bits + 63) / 64 + 1, 0); // +1 padding word
+        for (size_t j = 0; j < CHUNK_SIZE; j++)
+        {
+            uint64_t delta = uint32_t(tail[j]) - uint32_t(lo);
+            size_t bit = j * bits;
+            size_t w = offset + bit / 64, shift = bit % 64;
+            words[w] |= delta << shift;
+            if (shift + bits > 64) words[w + 1] |= delta >> (64 - shift);
+        }
+        directory.push_back({ lo, bits, offset });
+        tailSize = 0;
+    }
+
+public:
+    void push_back(int value)
+    {
+        tail[tailSize++] = value;
+        if (tailSize == CHUNK_SIZE) seal();
+    }
+
+    size_t get_size() const { return directory.size() * CHUNK_SIZE + tailSize; }
+
+    int operator[](size_t index) const
+    {
+        size_t chunk = index / CHUNK_SIZE, j = index % CHUNK_SIZE;
+        if (chunk == directory.size()) return tail[j];
+        const ChunkEntry& e = directory[chunk];
+        if (e.bits == 0) return e.base; // in[1] would be past the end for the last chunk
+        size_t bit = j * e.bits;
+        const uint64_t* in = &words[e.wordOffset + bit / 64];
+        size_t shift = bit % 64;
+        uint64_t raw = (in[0] >> shift) | ((in[1] << 1) << (63 - shift));
+        uint64_t mask = ~0ull >> (64 - e.bits);
+        return int(uint32_t(e.base) + uint32_t(raw & mask));
+    }
+
+    // calls f(values, count) once per chunk, sealed chunks are unpacked into a buffer that stays in L1
+    template<typename F>
+    void forEachChunk(F f) const
+    {
+        int buffer[CHUNK_SIZE];
+        const Unpacker* table = unpackers();
+        for (const ChunkEntry& e : directory)
+        {
+            table[e.bits](&words[e.wordOffset], e.base, buffer);
+            f(static_cast<const int*>(buffer), CHUNK_SIZE);
+        }
+        if (tailSize) f(static_cast<const int*>(tail), tailSize);
+    }
+
+    size_t bytes() const { return words.size() * sizeof(uint64_t) + directory.size() * sizeof(ChunkEntry) + sizeof(tail); }
+
+    double averageBits() const
+    {
+        double total = 0;
+        for (auto& e : directory) total += e.bits;
+        return directory.empty() ? 0 : total / double(directory.size());
+    }
+};
+
+
+template<typename F>
+double bestOf(F f, int repeats = 5)
+{
+    double best = 1e300;
+    for (int r = 0; r < repeats; r++)
+    {
+        auto start = Clock::now();
+        volatile long long sink = f();
+        (void)sink;
+        std::chrono::duration<double> duration = Clock::now() - start;
+        best = std::min(best, duration.count());
+    }
+    return best;
+}
+
+void runCase(const char* name, const std::vector<int>& values, const std::vector<size_t>& indices)
+{
+    ChunkedVector<int> plain;
+    PackedChunkedVector<> packed;
+    for (int v : values) plain.push_back(v), packed.push_back(v);
+
+    size_t n = values.size();
+    long long expected = 0;
+    for (int v : values) expected += v;
+    long long packedSum = 0;
+    packed.forEachChunk([&](const int* chunk, size_t count) { for (size_t j = 0; j < count; j++) packedSum += chunk[j]; });
+    if (packedSum != expected) std::cout << "  warning: packed scan mismatch\n";
+    for (size_t k = 0; k < 1000; k++)
+        if (packed[indices[k]] != values[indices[k]]) { std::cout << "  warning: packed read mismatch\n"; break; }
+
+    double plainScan = bestOf([&] {
+        long long sum = 0;
+        for (size_t i = 0; i < n; i++) sum += plain[i];
+        return sum;
+    });
+    double packedScan = bestOf([&] {
+        long long sum = 0;
+        packed.forEachChunk([&](const int* chunk, size_t count) { for (size_t j = 0; j < count; j++) sum += chunk[j]; });
+        return sum;
+    });
+    double plainRandom = bestOf([&] {
+        long long sum = 0;
+        for (size_t index : indices) sum += plain[index];
+        return sum;
+    });
+    double packedRandom = bestOf([&] {
+        long long sum = 0;
+        for (size_t index : indices) sum += packed[index];
+        return sum;
+    });
+
+    const double MB = 1024.0 * 1024.0;
+    std::cout << std::setw(22) << name
+        << std::setw(8) << packed.averageBits()
+        << std::setw(12) << plain.bytes() / MB
+        << std::setw(12) << packed.bytes() / MB
+        << std::setw(14) << n / plainScan / 1e6
+        << std::setw(14) << n / packedScan / 1e6
+        << std::setw(14) << indices.size() / plainRandom / 1e6
+        << std::setw(14) << indices.size() / packedRandom / 1e6
+        << "\n";
+}
+
+int main()
+{
+    const size_t N = 25'000'000;
+    const size_t RANDOM_READS = 5'000'000;
+
+    std::mt19937_64 rng(123);
+    std::uniform_int_distribution<size_t> pick(0, N - 1);
+    std::vector<size_t> indices(RANDOM_READS);
+    for (auto& index : indices) index = pick(rng);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "ChunkedVector<int> vs PackedChunkedVector (" << N << " values, " << RANDOM_READS << " random reads)\n\n";
+    std::cout << std::setw(22) << "values"
+        << std::setw(8) << "bits"
+        << std::setw(12) << "plain MB"
+        << std::setw(12) << "packed MB"
+        << std::setw(14) << "plain scan"
+        << std::setw(14) << "packed scan"
+        << std::setw(14) << "plain rand"
+        << std::setw(14) << "packed rand"
+        << "    (M values/s)\n";
+
+    // round trip at the edges of int, deltas above INT_MAX must wrap back correctly
+    {
+        PackedChunkedVector<> edge;
+        std::vector<int> expected;
+        const int extremes[] = { INT_MIN, INT_MIN + 1, -1, 0, 1, INT_MAX - 1, INT_MAX };
+        for (size_t i = 0; i < 3000; i++) expected.push_back(extremes[(i * 5) % 7]);
+        for (int v : expected) edge.push_back(v);
+        bool ok = true;
+        for (size_t i = 0; i < expected.size(); i++) ok &= edge[i] == expected[i];
+        size_t at = 0;
+        edge.forEachChunk([&](const int* chunk, size_t count) { for (size_t j = 0; j < count; j++) ok &= chunk[j] == expected[at++]; });
+        if (!ok) std::cout << "warning: values near INT_MIN/INT_MAX don't round trip\n";
+    }
+
+    std::vector<int> values(N);
+    for (size_t i = 0; i < N; i++) values[i] = int(i);
+    runCase("sequential 0..N", values, indices);
+
+    for (int bits : { 5, 12, 20 })
+    {
+        std::uniform_int_distribution<int> dist(0, (1 << bits) - 1);
+        for (auto& v : values) v = dist(rng);
+        std::string name = "random " + std::to_string(bits) + "-bit";
+        runCase(name.c_str(), values, indices);
+    }
+
+    std::fill(values.begin(), values.end(), 42); // every chunk gets 0 bits
+    runCase("constant column", values, indices);
+
+    std::uniform_int_distribution<int> full(-2'000'000'000, 2'000'000'000);
+    for (auto& v : values) v = full(rng);
+    runCase("random full range", values, indices);
+    return 0;
+}
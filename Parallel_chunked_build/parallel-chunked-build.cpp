@@ -0,0 +1,208 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <cstdint>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+A ChunkedVector is just a list of chunk pointers, so two of them can be joined by appending pointers, no element is
+copied. That is O(chunks) instead of O(elements), and it makes building in parallel easy:
+- buildParallel splits the chunk range between threads, every thread fills its own ChunkedVector (its own chunks,
+  allocated and first touched by that thread), then the pieces are spliced together in order
+- splice(other) moves all chunks of other to the end of this vector
+- split_at(index) moves everything from index on into a new ChunkedVector
+Both are O(chunks) when the boundary is a multiple of CHUNK_SIZE, which is always the case for buildParallel.
+Otherwise elements have to shift inside the chunks (operator[] relies on every chunk but the last being full),
+then we fall back to copying the elements after the boundary.
+*/
+
+//CHUNKED VECTOR WITH NEW[] (same as in Vector_allocation_benhmarks, plus splice and split_at)
+template<typename T, size_t CHUNK_SIZE = 64>
+class ChunkedVector {
+    std::vector<T*> chunks;
+    size_t size = 0;
+
+public:
+    ChunkedVector() = default;
+    ChunkedVector(const ChunkedVector&) = delete;
+    ChunkedVector& operator=(const ChunkedVector&) = delete;
+    ChunkedVector(ChunkedVector&& other) noexcept : chunks(std::move(other.chunks)), size(other.size) { other.size = 0; }
+    ChunkedVector& operator=(ChunkedVector&& other) noexcept {
+        std::swap(chunks, other.chunks);
+        std::swap(size, other.size);
+        return *this;
+    }
+
+    ~ChunkedVector() {
+        for (auto chunk : chunks) delete[] chunk;
+    }
+
+    void push_back(const T& value) {
+        if (size % CHUNK_SIZE == 0)
+            chunks.push_back(new T[CHUNK_SIZE]);
+        chunks[size / CHUNK_SIZE][size % CHUNK_SIZE] = value;
+        size++;
+    }
+
+    T& operator[](size_t index) {
+        return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+
+    size_t get_size() const { return size; }
+    size_t chunk_count() const { return chunks.size(); }
+
+    // moves all elements of other to the end, other is empty afterwards
+    void splice(ChunkedVector& other) {
+        if (size % CHUNK_SIZE == 0) // our last chunk is full, just take the pointers
+        {
+            chunks.insert(chunks.end(), other.chunks.begin(), other.chunks.end());
+            size += other.size;
+            other.chunks.clear();
+        }
+        else
+        {
+            for (size_t i = 0; i < other.size; i++) push_back(other[i]);
+            for (auto chunk : other.chunks) delete[] chunk;
+            other.chunks.clear();
+        }
+        other.size = 0;
+    }
+
+    // elements [index, size) move into the returned vector, this keeps [0, index)
+    ChunkedVector split_at(size_t index) {
+        ChunkedVector tail;
+        if (index >= size) return tail;
+        size_t firstChunk = (index + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        if (index % CHUNK_SIZE == 0)
+        {
+            tail.chunks.assign(chunks.begin() + firstChunk, chunks.end());
+            tail.size = size - index;
+        }
+        else
+        {
+            for (size_t i = index; i < size; i++) tail.push_back((*this)[i]);
+            for (size_t c = firstChunk; c < chunks.size(); c++) delete[] chunks[c];
+        }
+        chunks.resize(firstChunk);
+        size = index;
+        return tail;
+    }
+
+    // fills [0, n) with generate(i), threads work on disjoint chunk ranges and the results are spliced in order
+    template<typename Generate>
+    static ChunkedVector buildParallel(size_t n, unsigned threads, Generate generate) {
+        size_t totalChunks = (n + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        size_t chunksPerThread = (totalChunks + threads - 1) / threads;
+        std::vector<ChunkedVector> parts(threads);
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++)
+            workers.emplace_back([&, t] {
+                size_t begin = std::min(n, t * chunksPerThread * CHUNK_SIZE);
+                size_t end = std::min(n, (t + 1) * chunksPerThread * CHUNK_SIZE);
+                ChunkedVector& part = parts[t];
+                part.chunks.reserve(chunksPerThread);
+                for (size_t i = begin; i < end; i += CHUNK_SIZE) // whole chunks, no per-element size check
+                {
+                    T* chunk = new T[CHUNK_SIZE];
+                    size_t count = std::min(CHUNK_SIZE, end - i);
+                    for (size_t j = 0; j < count; j++) chunk[j] = generate(i + j);
+                    part.chunks.push_back(chunk);
+                }
+                part.size = end - begin;
+            });
+        for (auto& w : workers) w.join();
+
+        ChunkedVector result;
+        result.chunks.reserve(totalChunks);
+        for (auto& part : parts) result.splice(part);
+        return result;
+    }
+};
+
+
+inline int valueAt(size_t i) { return int(uint32_t(i) * 2654435761u >> 4); } // something cheap but not just i
+
+template<typename F>
+double timeMs(F f)
+{
+    auto start = Clock::now();
+    f();
+    std::chrono::duration<double, std::milli> duration = Clock::now() - start;
+    return duration.count();
+}
+
+template<typename V>
+bool check(V& v, size_t n)
+{
+    if (v.get_size() != n) return false;
+    for (size_t i = 0; i < n; i += 997)
+        if (v[i] != valueAt(i)) return false;
+    return v[n - 1] == valueAt(n - 1);
+}
+
+int main()
+{
+    const size_t N = 25'000'000;
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Building a ChunkedVector<int, 4096> of " << N << " elements, hardware threads: " << hw << "\n\n";
+    std::cout << std::setw(10) << "threads"
+        << std::setw(20) << "serial push_back"
+        << std::setw(24) << "vector + parallel copy"
+        << std::setw(24) << "parallel build+splice"
+        << "    (ms)\n";
+
+    using Chunked = ChunkedVector<int, 4096>;
+    std::vector<unsigned> threadCounts = { 1, 2, 4, 8 };
+    if (hw > 8) threadCounts.push_back(hw);
+    for (unsigned threads : threadCounts)
+    {
+        double serialMs, copyMs, buildMs;
+        {
+            Chunked v;
+            serialMs = timeMs([&] { for (size_t i = 0; i < N; i++) v.push_back(valueAt(i)); });
+            if (!check(v, N)) std::cout << "  warning: serial build is wrong\n";
+        }
+        {
+            Chunked v;
+            copyMs = timeMs([&] {
+                std::vector<int> plain(N);
+                for (size_t i = 0; i < N; i++) plain[i] = valueAt(i);
+                v = Chunked::buildParallel(N, threads, [&](size_t i) { return plain[i]; });
+            });
+            if (!check(v, N)) std::cout << "  warning: copy build is wrong\n";
+        }
+        {
+            Chunked v;
+            buildMs = timeMs([&] { v = Chunked::buildParallel(N, threads, valueAt); });
+            if (!check(v, N)) std::cout << "  warning: parallel build is wrong\n";
+        }
+        std::cout << std::setw(10) << threads
+            << std::setw(20) << serialMs
+            << std::setw(24) << copyMs
+            << std::setw(24) << buildMs
+            << "\n";
+    }
+
+    // split_at / splice on whole chunks only move pointers
+    Chunked v = Chunked::buildParallel(N, hw, valueAt);
+    size_t aligned = (N / 2) / 4096 * 4096;
+    Chunked tail;
+    double splitMs = timeMs([&] { tail = v.split_at(aligned); });
+    double spliceMs = timeMs([&] { v.splice(tail); });
+    bool ok = check(v, N);
+    double unalignedSplitMs = timeMs([&] { tail = v.split_at(aligned + 1); });
+    double unalignedSpliceMs = timeMs([&] { v.splice(tail); });
+    ok = ok && check(v, N);
+
+    std::cout << "\nsplit_at + splice in the middle (" << v.chunk_count() << " chunks):\n";
+    std::cout << "  chunk aligned:   split_at " << splitMs << " ms, splice " << spliceMs << " ms\n";
+    std::cout << "  unaligned (+1):  split_at " << unalignedSplitMs << " ms, splice " << unalignedSpliceMs << " ms (elements copied)\n";
+    if (!ok) std::cout << "  warning: split_at/splice changed the contents\n";
+    return 0;
+}
@@ -0,0 +1,330 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <map>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+PoolAllocator (Vector_allocation_benhmarks) keeps every buffer until it's destroyed, so after a load spike the process
+stays at its peak RSS forever. TrimmingPoolAllocator has the same bump allocation inside buffers, plus:
+- deallocate(): every buffer counts its live blocks, a buffer whose count drops to 0 is fully free and goes to a free list
+- trimming: when occupancy (buffers in use / buffers with resident memory) drops below a threshold, free buffers beyond
+  a warm reserve get their pages returned to the OS with madvise. The mapping stays, so reusing the buffer later just
+  page-faults fresh zero pages back in, that's the re-growth cost we measure.
+  MADV_DONTNEED drops pages right away (RSS goes down now), MADV_FREE lets the kernel take them lazily when it needs
+  memory (cheaper, but RSS only goes down under pressure).
+- optional PSI: if /proc/pressure/memory says tasks were stalled on memory recently (some avg10 above a threshold),
+  the warm reserve is ignored and everything free gets trimmed.
+The occupancy check on deallocate is O(1) (running count of resident buffers), and trimming from deallocate is rate
+limited by minTrimIntervalMs, so a burst of frees doesn't read /proc/pressure/memory once per buffer.
+Buffers are mmap'ed on Linux, so they are page aligned and madvise applies to exactly their pages. On other systems we
+fall back to new[]/delete[] and trimming deletes the buffer.
+*/
+
+struct TrimPolicy
+{
+    bool enabled = true;
+    size_t warmReserve = 0;           // free buffers we keep resident for the next spike
+    double occupancyThreshold = 0.75; // trim when fewer than this fraction of resident buffers are in use
+    bool useMadvFree = false;
+    double psiThreshold = 10.0;       // some avg10 (percent) that counts as memory pressure, <0 = don't read PSI
+    double minTrimIntervalMs = 5.0;   // deallocate trims at most this often (PSI read + free list walk), trim() always runs
+};
+
+// "some avg10=1.23 ..." from /proc/pressure/memory, -1 if not available
+double readMemoryPressure()
+{
+    std::ifstream in("/proc/pressure/memory");
+    std::string kind, avg10;
+    if (!(in >> kind >> avg10) || kind != "some" || avg10.rfind("avg10=", 0) != 0) return -1;
+    return std::stod(avg10.substr(6));
+}
+
+// resident set size of the process in bytes, from /proc/self/statm, 0 if not available
+size_t residentBytes()
+{
+#ifdef __linux__
+    std::ifstream in("/proc/self/statm");
+    size_t pages, resident;
+    if (in >> pages >> resident) return resident * size_t(sysconf(_SC_PAGESIZE));
+#endif
+    return 0;
+}
+
+template<typename T>
+class TrimmingPoolAllocator
+{
+    struct Buffer
+    {
+        T* data = nullptr;
+        size_t live = 0;       // blocks handed out and not yet deallocated
+        bool resident = false; // false after trimming, the pages are not backed anymore
+    };
+
+    std::vector<Buffer> buffers;
+    std::map<uintptr_t, size_t> bufferOf; // start address -> buffer, for deallocate
+    std::vector<size_t> freeBuffers;      // fully free, resident or not
+    size_t capacity;                      // elements per buffer
+    size_t current = SIZE_MAX;            // buffer we bump allocate from
+    size_t offset = 0;
+    TrimPolicy policy;
+
+    size_t buffersInUse = 0;
+    size_t resident = 0; // buffers with mapped, resident pages
+    Clock::time_point lastTrim{};
+
+    size_t bufferBytes() const { return capacity * sizeof(T); }
+
+    T* mapBuffer()
+    {
+#ifdef __linux__
+        void* p = mmap(nullptr, bufferBytes(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return p == MAP_FAILED ? nullptr : static_cast<T*>(p);
+#else
+        return new T[capacity];
+#endif
+    }
+
+    void unmapBuffer(Buffer& b)
+    {
+#ifdef __linux__
+        munmap(b.data, bufferBytes());
+#else
+        delete[] b.data;
+#endif
+        b.data = nullptr;
+    }
+
+    void dropPages(Buffer& b)
+    {
+#ifdef __linux__
+#ifdef MADV_FREE
+        if (policy.useMadvFree) madvise(b.data, bufferBytes(), MADV_FREE);
+        else
+#endif
+        madvise(b.data, bufferBytes(), MADV_DONTNEED);
+#else
+        bufferOf.erase(uintptr_t(b.data));
+        unmapBuffer(b);
+#endif
+        b.resident = false;
+        resident--;
+    }
+
+    size_t takeBuffer()
+    {
+        size_t index;
+        if (!freeBuffers.empty())
+        {
+            // prefer a resident (warm) buffer, those don't page fault
+            auto warm = std::find_if(freeBuffers.begin(), freeBuffers.end(), [&](size_t i) { return buffers[i].resident; });
+            if (warm == freeBuffers.end()) warm = freeBuffers.end() - 1;
+            index = *warm;
+            *warm = freeBuffers.back();
+            freeBuffers.pop_back();
+        }
+        else
+        {
+            index = buffers.size();
+            buffers.emplace_back();
+        }
+        Buffer& b = buffers[index];
+        if (!b.data)
+        {
+            b.data = mapBuffer();
+            if (!b.data)
+            {
+                freeBuffers.push_back(index); // still unmapped, takeBuffer maps it next time
+                throw std::bad_alloc();
+            }
+            bufferOf[uintptr_t(b.data)] = index;
+        }
+        if (!b.resident) resident++;
+        b.resident = true;
+        buffersInUse++;
+        return index;
+    }
+
+public:
+    TrimmingPoolAllocator(size_t cap, TrimPolicy policy = TrimPolicy()) : capacity(cap), policy(policy) {}
+
+    ~TrimmingPoolAllocator()
+    {
+        for (auto& b : buffers)
+            if (b.data) unmapBuffer(b);
+    }
+
+    T* allocate(size_t n)
+    {
+        if (current == SIZE_MAX || offset + n > capacity)
+        {
+            current = takeBuffer();
+            offset = 0;
+        }
+        Buffer& b = buffers[current];
+        T* ptr = b.data + offset; // carve from the buffer
+        offset += n;
+        b.live++;
+        return ptr;
+    }
+
+    void deallocate(T* ptr)
+    {
+        auto it = std::prev(bufferOf.upper_bound(uintptr_t(ptr)));
+        size_t index = it->second;
+        Buffer& b = buffers[index];
+        if (--b.live) return;
+        buffersInUse--;
+        if (index == current) current = SIZE_MAX; // don't bump into a free buffer, it is reused from the free list
+        freeBuffers.push_back(index);
+        maybeTrim();
+    }
+
+    // cheap occupancy check, called whenever a buffer becomes free
+    void maybeTrim()
+    {
+        if (!policy.enabled) return;
+        if (resident && double(buffersInUse) >= policy.occupancyThreshold * double(resident)) return;
+        Clock::time_point now = Clock::now();
+        if (std::chrono::duration<double, std::milli>(now - lastTrim).count() < policy.minTrimIntervalMs) return;
+        trim();
+    }
+
+    void trim()
+    {
+        if (!policy.enabled) return;
+        lastTrim = Clock::now();
+        size_t reserve = policy.warmReserve;
+        if (policy.psiThreshold >= 0 && readMemoryPressure() > policy.psiThreshold) reserve = 0;
+        size_t warm = 0;
+        for (size_t index : freeBuffers)
+        {
+            Buffer& b = buffers[index];
+            if (!b.data || !b.resident) continue;
+            if (warm < reserve) { warm++; continue; }
+            dropPages(b);
+        }
+    }
+
+    size_t mappedBytes() const
+    {
+        size_t n = 0;
+        for (auto& b : buffers) n += b.data ? bufferBytes() : 0;
+        return n;
+    }
+};
+
+
+struct Phase
+{
+    const char* name;
+    double ms;
+    long long rss; // against the RSS before the scenario, negative when we gave back more than we took
+};
+
+// allocate the spike block by block and touch every page like a real kernel would
+template<typename Pool>
+void spike(Pool& pool, std::vector<float*>& live, size_t blocks, size_t blockElements)
+{
+    for (size_t k = 0; k < blocks; k++)
+    {
+        float* p = pool.allocate(blockElements);
+        for (size_t i = 0; i < blockElements; i += 1024) p[i] = float(i); // one write per 4 KB page
+        live.push_back(p);
+    }
+}
+
+std::vector<Phase> runScenario(TrimPolicy policy, size_t spikeBlocks, size_t blockElements, size_t bufferElements)
+{
+    std::vector<Phase> phases;
+    long long baseRss = (long long)residentBytes();
+    auto rssGrowth = [&] { return (long long)residentBytes() - baseRss; };
+    TrimmingPoolAllocator<float> pool(bufferElements, policy);
+    std::vector<float*> live;
+    std::mt19937_64 rng(123);
+
+    auto start = Clock::now();
+    spike(pool, live, spikeBlocks, blockElements);
+    std::chrono::duration<double, std::milli> t = Clock::now() - start;
+    phases.push_back({ "spike", t.count(), rssGrowth() });
+
+    // load goes away, the oldest 2% of blocks (long-lived state) stay, the rest is freed in random order.
+    // A bump pool can only reuse or trim fully free buffers, so long-lived blocks spread over every buffer would pin them all.
+    start = Clock::now();
+    size_t keep = live.size() / 50;
+    std::shuffle(live.begin() + keep, live.end(), rng);
+    for (size_t k = keep; k < live.size(); k++) pool.deallocate(live[k]);
+    live.resize(keep);
+    t = Clock::now() - start;
+    phases.push_back({ "release", t.count(), rssGrowth() });
+
+    start = Clock::now();
+    pool.trim(); // idle tick
+    t = Clock::now() - start;
+    phases.push_back({ "idle", t.count(), rssGrowth() });
+
+    start = Clock::now();
+    spike(pool, live, spikeBlocks, blockElements);
+    t = Clock::now() - start;
+    phases.push_back({ "re-spike", t.count(), rssGrowth() });
+
+    for (float* p : live) pool.deallocate(p);
+    return phases;
+}
+
+int main()
+{
+    const size_t BUFFER_ELEMENTS = 1 << 20;  // 4 MB buffers
+    const size_t BLOCK_ELEMENTS = 16 * 1024; // 64 KB blocks
+    const size_t SPIKE_BLOCKS = 4096;        // 256 MB spike
+
+    std::cout << std::fixed << std::setprecision(1);
+    double psi = readMemoryPressure();
+    std::cout << "Spike-then-idle, " << SPIKE_BLOCKS * BLOCK_ELEMENTS * sizeof(float) / (1024 * 1024) << " MB spike, "
+        << BUFFER_ELEMENTS * sizeof(float) / (1024 * 1024) << " MB pool buffers, ";
+    if (psi < 0) std::cout << "PSI not available\n";
+    else std::cout << "PSI some avg10 = " << psi << "%\n";
+    if (residentBytes() == 0) std::cout << "(no /proc/self/statm, RSS columns are 0)\n";
+    std::cout << "\n";
+
+    struct Named { const char* name; TrimPolicy policy; };
+    std::vector<Named> policies;
+    TrimPolicy p;
+    p.enabled = false;
+    policies.push_back({ "no trimming", p });
+    p = TrimPolicy();
+    policies.push_back({ "DONTNEED, reserve 0", p });
+    p.warmReserve = 16;
+    policies.push_back({ "DONTNEED, reserve 16", p });
+    p = TrimPolicy();
+    p.useMadvFree = true;
+    policies.push_back({ "MADV_FREE, reserve 0", p });
+
+    std::cout << std::setw(24) << "policy";
+    for (const char* phase : { "spike", "release", "idle", "re-spike" })
+        std::cout << std::setw(10) << phase << " ms" << std::setw(11) << "RSS MB";
+    std::cout << "\n";
+
+    for (auto& named : policies)
+    {
+        std::vector<Phase> phases = runScenario(named.policy, SPIKE_BLOCKS, BLOCK_ELEMENTS, BUFFER_ELEMENTS);
+        std::cout << std::setw(24) << named.name;
+        for (auto& phase : phases) std::cout << std::setw(13) << phase.ms << std::setw(11) << double(phase.rss) / (1024 * 1024);
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,277 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+Kernels like radix sort, compaction and group-by need temporary buffers, and with std::vector every call pays
+for malloc + zeroing + free, and gets memory that is cold in cache. For small batches that is most of the time.
+Every thread instead gets its own ScratchArena (thread_local, so no locks and no sharing between cores):
+- it's a stack allocator: ScratchBuffer<T> takes n elements from the top in its constructor and gives them back in its
+  destructor, so nested buffers inside one kernel just work as long as they are destroyed in reverse order (RAII does that)
+- when the current block is too small we add a block at least twice as big as everything so far (geometric growth),
+  and when the arena is empty again we keep only that last block, so after a few calls every kernel fits in one block
+- the same memory is reused call after call, so it stays in L1/L2
+ScratchBuffer memory is not initialized, kernels that need zeros (histograms, hash tables) clear it themselves.
+*/
+
+class ScratchArena
+{
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> memory;
+        size_t capacity;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0; // block we bump into
+    size_t top = 0;     // offset in the current block
+    size_t live = 0;    // buffers not given back yet
+    size_t totalCapacity = 0;
+
+public:
+    struct Mark
+    {
+        size_t block, top;
+    };
+
+    void* push(size_t bytes, size_t align, Mark& mark)
+    {
+        mark = { current, top };
+        live++;
+        while (true)
+        {
+            if (current < blocks.size())
+            {
+                uintptr_t base = uintptr_t(blocks[current].memory.get());
+                uintptr_t aligned = (base + top + align - 1) & ~uintptr_t(align - 1);
+                if (aligned + bytes <= base + blocks[current].capacity)
+                {
+                    top = aligned + bytes - base;
+                    return reinterpret_cast<void*>(aligned);
+                }
+                if (current + 1 < blocks.size()) { current++, top = 0; continue; } // bigger block from before
+            }
+            size_t capacity = std::max<size_t>({ 64 * 1024, 2 * totalCapacity, bytes + align });
+            blocks.push_back({ std::unique_ptr<uint8_t[]>(new uint8_t[capacity]), capacity });
+            totalCapacity += capacity;
+            current = blocks.size() - 1, top = 0;
+        }
+    }
+
+    void pop(const Mark& mark)
+    {
+        current = mark.block, top = mark.top;
+        if (--live == 0 && blocks.size() > 1)
+        {
+            // the last block is bigger than all others together, keep only that one
+            Block last = std::move(blocks.back());
+            blocks.clear();
+            totalCapacity = last.capacity;
+            blocks.push_back(std::move(last));
+            current = 0, top = 0;
+        }
+    }
+
+    size_t capacity() const { return totalCapacity; }
+};
+
+inline ScratchArena& localArena()
+{
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+template<typename T>
+class ScratchBuffer
+{
+    ScratchArena& arena;
+    ScratchArena::Mark mark;
+    T* ptr;
+    size_t count;
+
+public:
+    explicit ScratchBuffer(size_t n) : arena(localArena()), count(n)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "scratch memory is given back without destructors");
+        ptr = static_cast<T*>(arena.push(n * sizeof(T), alignof(T) < 64 ? 64 : alignof(T), mark)); // cache line aligned
+    }
+    ~ScratchBuffer() { arena.pop(mark); }
+    ScratchBuffer(const ScratchBuffer&) = delete;
+    ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+    T* data() { return ptr; }
+    size_t size() const { return count; }
+    T& operator[](size_t i) { return ptr[i]; }
+    T* begin() { return ptr; }
+    T* end() { return ptr + count; }
+};
+
+// what the kernels did before: a fresh std::vector per call
+template<typename T>
+class VectorBuffer
+{
+    std::vector<T> v;
+
+public:
+    explicit VectorBuffer(size_t n) : v(n) {}
+    T* data() { return v.data(); }
+    size_t size() const { return v.size(); }
+    T& operator[](size_t i) { return v[i]; }
+    T* begin() { return v.data(); }
+    T* end() { return v.data() + v.size(); }
+};
+
+
+// ---------- kernels, the buffer type is a template parameter ----------
+
+// LSD radix sort, 4 passes of 8 bits, needs a second key array and a histogram
+template<template<typename> class Buffer>
+void radixSort(uint32_t* keys, size_t n)
+{
+    Buffer<uint32_t> other(n);
+    Buffer<uint32_t> counts(256);
+    uint32_t* from = keys;
+    uint32_t* to = other.data();
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        std::fill(counts.begin(), counts.end(), 0u);
+        for (size_t i = 0; i < n; i++) counts[(from[i] >> shift) & 0xff]++;
+        uint32_t sum = 0;
+        for (auto& c : counts) { uint32_t tmp = c; c = sum; sum += tmp; }
+        for (size_t i = 0; i < n; i++) to[counts[(from[i] >> shift) & 0xff]++] = from[i];
+        std::swap(from, to);
+    }
+    // 4 passes, so the result ends up back in keys
+}
+
+// mass of particles with x > 0, packed into out, returns how many
+template<template<typename> class Buffer>
+size_t compactPositive(const float* x, const float* mass, size_t n, float* out)
+{
+    Buffer<uint32_t> selected(n);
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        selected[count] = uint32_t(i);
+        count += x[i] > 0.0f; // branchless selection
+    }
+    for (size_t k = 0; k < count; k++) out[k] = mass[selected[k]];
+    return count;
+}
+
+// number of distinct cell ids, open-addressing table in scratch memory
+template<template<typename> class Buffer>
+size_t groupCount(const int* cells, size_t n)
+{
+    size_t size = 16;
+    while (size < 2 * n) size <<= 1;
+    Buffer<int64_t> table(size); // -1 = empty
+    std::fill(table.begin(), table.end(), int64_t(-1));
+    size_t groups = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t pos = (uint32_t(cells[i]) * 2654435761u) & (size - 1);
+        while (table[pos] != -1 && table[pos] != cells[i]) pos = (pos + 1) & (size - 1);
+        if (table[pos] == -1) table[pos] = cells[i], groups++;
+    }
+    return groups;
+}
+
+
+struct Batch
+{
+    std::vector<uint32_t> keys, sortInput;
+    std::vector<float> x, mass, out;
+    std::vector<int> cells;
+
+    Batch(size_t n, std::mt19937_64& rng) : keys(n), sortInput(n), x(n), mass(n), out(n), cells(n)
+    {
+        std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+        std::uniform_int_distribution<int> cell(0, int(n / 4) + 1);
+        for (size_t i = 0; i < n; i++) keys[i] = uint32_t(rng()), x[i] = dist(rng), mass[i] = dist(rng), cells[i] = cell(rng);
+    }
+};
+
+// one call = radix sort + compaction + group-by on one small batch
+template<template<typename> class Buffer>
+size_t runKernels(Batch& b)
+{
+    std::copy(b.keys.begin(), b.keys.end(), b.sortInput.begin());
+    radixSort<Buffer>(b.sortInput.data(), b.sortInput.size());
+    size_t kept = compactPositive<Buffer>(b.x.data(), b.mass.data(), b.x.size(), b.out.data());
+    size_t groups = groupCount<Buffer>(b.cells.data(), b.cells.size());
+    return b.sortInput[0] + kept + groups;
+}
+
+// every thread runs calls kernel calls on its own batch, returns ns per call
+template<template<typename> class Buffer>
+double benchmark(size_t batchSize, unsigned threads, size_t calls)
+{
+    std::vector<std::thread> workers;
+    auto start = Clock::now();
+    for (unsigned t = 0; t < threads; t++)
+        workers.emplace_back([=] {
+            std::mt19937_64 rng(123 + t);
+            Batch batch(batchSize, rng);
+            size_t sink = 0;
+            for (size_t c = 0; c < calls; c++) sink += runKernels<Buffer>(batch);
+            volatile size_t keep = sink;
+            (void)keep;
+        });
+    for (auto& w : workers) w.join();
+    std::chrono::duration<double, std::nano> duration = Clock::now() - start;
+    return duration.count() / double(calls); // wall time per call of one thread
+}
+
+int main()
+{
+    const size_t ELEMENTS_PER_THREAD = 20'000'000; // calls = this / batch size
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+
+    // sanity check: both buffer types give the same result
+    {
+        std::mt19937_64 rng(7);
+        Batch a(1000, rng);
+        Batch b = a;
+        size_t withVector = runKernels<VectorBuffer>(a), withScratch = runKernels<ScratchBuffer>(b);
+        if (withVector != withScratch || !std::is_sorted(b.sortInput.begin(), b.sortInput.end()))
+            std::cout << "warning: scratch kernels give a different result\n";
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Kernel calls (radix sort + compaction + group-by) on small batches, std::vector vs ScratchBuffer\n\n";
+    std::cout << std::setw(10) << "threads"
+        << std::setw(12) << "batch"
+        << std::setw(18) << "vector ns/call"
+        << std::setw(18) << "scratch ns/call"
+        << std::setw(12) << "speedup"
+        << "\n";
+    for (unsigned threads : { 1u, hw })
+    {
+        for (size_t batchSize : { 64, 1024, 16384 })
+        {
+            size_t calls = ELEMENTS_PER_THREAD / batchSize;
+            double vectorNs = benchmark<VectorBuffer>(batchSize, threads, calls);
+            double scratchNs = benchmark<ScratchBuffer>(batchSize, threads, calls);
+            std::cout << std::setw(10) << threads
+                << std::setw(12) << batchSize
+                << std::setw(18) << vectorNs
+                << std::setw(18) << scratchNs
+                << std::setw(11) << vectorNs / scratchNs << "x"
+                << "\n";
+        }
+        if (hw == 1) break;
+    }
+    std::cout << "\narena of the main thread after the sanity check: " << localArena().capacity() / 1024 << " KB\n";
+    return 0;
+}
@@ -0,0 +1,305 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <memory>
+#include <fstream>
+#include <string>
+#include <cstring>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+Two hyperthreads of one core share its L1/L2, its load/store units and its execution ports. A scan-heavy service
+can lose a lot of throughput when the OS schedules something else on its SMT sibling, and that decides whether we
+should disable SMT on those machines.
+This harness pins the benchmark to one hyperthread and an antagonist to its sibling (same detection as in
+Helper_thread_prefetching):
+- none: sibling idle, the reference time
+- stream: memory streamer, copies two 64 MB buffers back and forth (fights for L1/L2, fill buffers and bandwidth)
+- alu: integer multiply/xor chains in registers, no memory at all (fights for execution ports only)
+- copy: another instance of the same benchmark on its own data
+and reports how much every container/layout slows down. Without SMT both threads are pinned to the same cpu, then the
+numbers show time sharing of one cpu. If pinning doesn't work at all (not Linux) both run unpinned, normally on separate
+cores, and the numbers show cross-core LLC/bandwidth contention. We print which of the three it is.
+Run with --antagonist=stream|alu|copy to run only one of them.
+*/
+
+struct ParticleAos
+{
+    float x, y, z;
+    double mass; // same layout as in AoS-SoA
+};
+
+//CHUNKED VECTOR WITH NEW[] (same as in Vector_allocation_benhmarks)
+template<typename T, size_t CHUNK_SIZE = 64>
+class ChunkedVector {
+    std::vector<T*> chunks;
+    size_t size = 0;
+
+public:
+    ~ChunkedVector() {
+        for (auto chunk : chunks) delete[] chunk;
+    }
+
+    void push_back(const T& value) {
+        if (size % CHUNK_SIZE == 0)
+            chunks.push_back(new T[CHUNK_SIZE]);
+        chunks[size / CHUNK_SIZE][size % CHUNK_SIZE] = value;
+        size++;
+    }
+
+    T& operator[](size_t index) {
+        return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+
+    size_t get_size() const { return size; }
+};
+
+
+// ---------- thread pinning (same as Helper_thread_prefetching) ----------
+
+struct SmtPair { int main = -1, helper = -1; };
+
+SmtPair findSmtSiblings()
+{
+    SmtPair pair;
+#ifdef __linux__
+    unsigned cpus = std::thread::hardware_concurrency();
+    for (unsigned cpu = 0; cpu < cpus; cpu++)
+    {
+        std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list");
+        std::string list;
+        if (!(in >> list)) continue;
+        size_t sep = list.find_first_of(",-");
+        if (sep == std::string::npos) continue; // this core has only one hyperthread
+        pair.main = std::stoi(list.substr(0, sep));
+        pair.helper = (list[sep] == '-') ? pair.main + 1 : std::stoi(list.substr(sep + 1));
+        break;
+    }
+#endif
+    return pair;
+}
+
+bool pinCurrentThread(int cpu)
+{
+#ifdef __linux__
+    if (cpu < 0) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+
+// ---------- workloads ----------
+
+// a workload owns its data, one call is one full pass, returns something so the pass can't be optimized away
+using Workload = std::function<double()>;
+
+enum Kind { AosScan, SoaScan, VectorTraversal, ChunkedTraversal, ChunkedRandom };
+const char* kindNames[] = { "AoS scan", "SoA scan", "std::vector<int>", "ChunkedVector<int>", "ChunkedVector random" };
+
+Workload makeWorkload(Kind kind, size_t n, unsigned seed)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    switch (kind)
+    {
+    case AosScan:
+    {
+        auto particles = std::make_shared<std::vector<ParticleAos>>(n);
+        for (auto& p : *particles) p = { dist(rng), dist(rng), dist(rng), double(dist(rng)) };
+        return [particles] {
+            double sum = 0;
+            for (auto& p : *particles) sum += p.x > 0.0f ? p.mass : 0.0;
+            return sum;
+        };
+    }
+    case SoaScan:
+    {
+        auto x = std::make_shared<std::vector<float>>(n), mass = std::make_shared<std::vector<float>>(n);
+        for (size_t i = 0; i < n; i++) (*x)[i] = dist(rng), (*mass)[i] = dist(rng);
+        return [x, mass] {
+            double sum = 0;
+            for (size_t i = 0; i < x->size(); i++) sum += (*x)[i] > 0.0f ? (*mass)[i] : 0.0f;
+            return sum;
+        };
+    }
+    case VectorTraversal:
+    {
+        auto v = std::make_shared<std::vector<int>>(n);
+        for (size_t i = 0; i < n; i++) (*v)[i] = int(i);
+        return [v] {
+            long long sum = 0;
+            for (int value : *v) sum += value;
+            return double(sum);
+        };
+    }
+    case ChunkedTraversal:
+    case ChunkedRandom:
+    {
+        auto v = std::make_shared<ChunkedVector<int>>();
+        for (size_t i = 0; i < n; i++) v->push_back(int(i));
+        auto indices = std::make_shared<std::vector<size_t>>();
+        if (kind == ChunkedRandom)
+        {
+            std::uniform_int_distribution<size_t> pick(0, n - 1);
+            indices->resize(n / 4);
+            for (auto& index : *indices) index = pick(rng);
+        }
+        return [v, indices, n] {
+            long long sum = 0;
+            if (indices->empty())
+                for (size_t i = 0; i < n; i++) sum += (*v)[i];
+            else
+                for (size_t index : *indices) sum += (*v)[index];
+            return double(sum);
+        };
+    }
+    }
+    return [] { return 0.0; };
+}
+
+
+// ---------- antagonists ----------
+
+enum Antagonist { None, Stream, Alu, Copy };
+const char* antagonistNames[] = { "none", "stream", "alu", "copy" };
+
+void runAntagonist(Antagonist kind, int cpu, std::atomic<bool>& stop, std::atomic<bool>& started, Kind victim, size_t n)
+{
+    pinCurrentThread(cpu);
+    volatile double sink = 0;
+    if (kind == Stream)
+    {
+        std::vector<char> a(64 << 20, 1), b(64 << 20, 2);
+        started = true;
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            for (size_t off = 0; off < a.size() && !stop.load(std::memory_order_relaxed); off += 1 << 20)
+                std::memcpy(&b[off], &a[off], 1 << 20);
+            std::swap(a, b);
+        }
+    }
+    else if (kind == Alu)
+    {
+        started = true;
+        uint64_t x = 1, y = 2, z = 3, w = 4; // 4 independent chains keep the multipliers busy
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            for (int i = 0; i < 4096; i++)
+            {
+                x = x * 6364136223846793005ull ^ (x >> 7);
+                y = y * 2862933555777941757ull ^ (y >> 11);
+                z = z * 3202034522624059733ull ^ (z >> 13);
+                w = w * 1442695040888963407ull ^ (w >> 17);
+            }
+        }
+        sink = double(x ^ y ^ z ^ w);
+    }
+    else if (kind == Copy)
+    {
+        Workload copy = makeWorkload(victim, n, 999); // its own data
+        started = true;
+        while (!stop.load(std::memory_order_relaxed)) sink = sink + copy();
+    }
+    else started = true;
+    (void)sink;
+}
+
+// mean pass time in ms of the workload on cpus.main with the antagonist on cpus.helper. We run passes for a fixed
+// wall-clock window instead of taking the best pass: a pass is about one scheduler slice, so when both threads share
+// one cpu the best pass is one where the antagonist happened not to run, and the slowdown would read close to 0%
+double measure(Kind kind, Workload& workload, Antagonist antagonist, const SmtPair& cpus, size_t n, double windowMs = 300.0)
+{
+    std::atomic<bool> stop{ false }, started{ false };
+    std::thread other;
+    if (antagonist != None)
+    {
+        other = std::thread(runAntagonist, antagonist, cpus.helper, std::ref(stop), std::ref(started), kind, n);
+        while (!started) std::this_thread::yield();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20)); // let it ramp up
+    }
+    size_t passes = 0;
+    auto start = Clock::now();
+    std::chrono::duration<double, std::milli> elapsed{ 0 };
+    while (passes < 3 || elapsed.count() < windowMs)
+    {
+        volatile double sink = workload();
+        (void)sink;
+        passes++;
+        elapsed = Clock::now() - start;
+    }
+    stop = true;
+    if (other.joinable()) other.join();
+    return elapsed.count() / double(passes);
+}
+
+int main(int argc, char** argv)
+{
+    const size_t N = 4'000'000;
+
+    std::vector<Antagonist> antagonists = { Stream, Alu, Copy };
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        for (Antagonist a : { Stream, Alu, Copy })
+            if (arg == std::string("--antagonist=") + antagonistNames[a]) antagonists = { a };
+    }
+
+    SmtPair cpus = findSmtSiblings();
+    bool smt = cpus.main >= 0;
+#ifdef __linux__
+    if (!smt)
+    {
+        int cpu = std::max(0, sched_getcpu()); // no sibling, share the cpu we are on
+        cpus.main = cpus.helper = cpu;
+    }
+#endif
+    if (!pinCurrentThread(cpus.main))
+    {
+        cpus.main = cpus.helper = -1; // the antagonist doesn't try either
+        std::cout << "can't pin threads here, benchmark and antagonist run unpinned (usually on separate cores),\n"
+                     "the numbers below show cross-core LLC/bandwidth contention, not SMT interference\n";
+    }
+    else if (!smt)
+        std::cout << "no SMT siblings found, benchmark and antagonist are both pinned to cpu " << cpus.main << ",\n"
+                     "the numbers below show time sharing of one cpu, not SMT interference\n";
+    else
+        std::cout << "benchmark on cpu " << cpus.main << ", antagonist on its SMT sibling cpu " << cpus.helper << "\n";
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\nmean pass in ms over a 300 ms window (" << N << " elements), slowdown against an idle sibling in brackets\n\n";
+    std::cout << std::setw(22) << "workload" << std::setw(12) << "idle";
+    for (Antagonist a : antagonists) std::cout << std::setw(22) << antagonistNames[a];
+    std::cout << "\n";
+
+    for (Kind kind : { AosScan, SoaScan, VectorTraversal, ChunkedTraversal, ChunkedRandom })
+    {
+        Workload workload = makeWorkload(kind, N, 123);
+        double idle = measure(kind, workload, None, cpus, N);
+        std::cout << std::setw(22) << kindNames[kind] << std::setw(12) << idle;
+        for (Antagonist a : antagonists)
+        {
+            double t = measure(kind, workload, a, cpus, N);
+            std::cout << std::setw(12) << t << " (" << std::setw(6) << 100.0 * (t / idle - 1.0) << "%)";
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,322 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+Exact distinct counts need a hash set or a sort of the whole column, exact percentiles need a sort or nth_element,
+both are slow and need memory proportional to the data. Sketches give an approximate answer in a few KB:
+- HyperLogLog for cardinality: hash every value, keep per register the max number of leading zeros seen
+- KLL for quantiles: a stack of "compactors", when a level fills up we sort it and keep every second value one level up
+  with double weight, so memory stays O(k log n)
+Both are mergeable, so every thread builds its own sketch over its part of the column and we merge them at the end.
+
+Updates come in batches (a whole column span, or one ChunkedVector chunk at a time), not one value per call.
+The HLL batch kernel first hashes a block of values into a small array (a tight loop without branches the compiler can
+vectorize) and only then does the register updates. KLL appends the batch straight into its level-0 buffer with memcpy.
+*/
+
+
+//CHUNKED VECTOR WITH NEW[] (same as in Vector_allocation_benhmarks, plus access to whole chunks)
+template<typename T, size_t CHUNK_SIZE = 64>
+class ChunkedVector {
+    std::vector<T*> chunks;
+    size_t size = 0;
+
+public:
+    ~ChunkedVector() {
+        for (auto chunk : chunks) delete[] chunk;
+    }
+
+    void push_back(const T& value) {
+        if (size % CHUNK_SIZE == 0)
+            chunks.push_back(new T[CHUNK_SIZE]);
+        chunks[size / CHUNK_SIZE][size % CHUNK_SIZE] = value;
+        size++;
+    }
+
+    T& operator[](size_t index) {
+        return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+
+    size_t get_size() const { return size; }
+    size_t chunk_count() const { return chunks.size(); }
+
+    // contiguous span of one chunk, the last one can be partly filled
+    const T* chunk_data(size_t chunk) const { return chunks[chunk]; }
+    size_t chunk_size(size_t chunk) const { return std::min(CHUNK_SIZE, size - chunk * CHUNK_SIZE); }
+};
+
+struct ParticlesSoA
+{
+    std::vector<float> x, y, z, mass;
+    ParticlesSoA(size_t n)
+    {
+        x.resize(n), y.resize(n), z.resize(n), mass.resize(n);
+    }
+};
+
+
+// ---------- HyperLogLog ----------
+
+inline uint64_t mix64(uint64_t v) // murmur3 finalizer, cheap and good enough for sketches
+{
+    v ^= v >> 33; v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33; v *= 0xc4ceb9fe1a85ec53ULL;
+    v ^= v >> 33;
+    return v;
+}
+
+inline int leadingZeros(uint64_t v)
+{
+#ifdef _MSC_VER
+    unsigned long i;
+    return _BitScanReverse64(&i, v) ? 63 - (int)i : 64;
+#else
+    return v ? __builtin_clzll(v) : 64;
+#endif
+}
+
+template<int P = 14> // 2^P registers, standard error about 1.04 / sqrt(2^P), 0.8% for P = 14
+class HyperLogLog
+{
+    static constexpr size_t M = size_t(1) << P;
+    static constexpr size_t BATCH = 256;
+    uint8_t registers[M] = {};
+
+public:
+    template<typename T>
+    void update(const T* values, size_t n)
+    {
+        static_assert(sizeof(T) <= sizeof(uint64_t), "values are hashed by their bits");
+        uint64_t hashes[BATCH];
+        for (size_t begin = 0; begin < n; begin += BATCH)
+        {
+            size_t count = std::min(BATCH, n - begin);
+            for (size_t i = 0; i < count; i++) // no branches, no stores to registers, vectorizes
+            {
+                uint64_t bits = 0;
+                std::memcpy(&bits, &values[begin + i], sizeof(T));
+                hashes[i] = mix64(bits);
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                uint64_t h = hashes[i];
+                size_t index = h >> (64 - P);
+                uint8_t rank = uint8_t(leadingZeros((h << P) | (uint64_t(1) << (P - 1))) + 1);
+                registers[index] = std::max(registers[index], rank);
+            }
+        }
+    }
+
+    void merge(const HyperLogLog& other)
+    {
+        for (size_t i = 0; i < M; i++) registers[i] = std::max(registers[i], other.registers[i]);
+    }
+
+    double estimate() const
+    {
+        double sum = 0;
+        size_t zeros = 0;
+        for (size_t i = 0; i < M; i++)
+        {
+            sum += std::ldexp(1.0, -registers[i]);
+            zeros += registers[i] == 0;
+        }
+        double alpha = 0.7213 / (1.0 + 1.079 / double(M));
+        double e = alpha * double(M) * double(M) / sum;
+        if (e <= 2.5 * double(M) && zeros) e = double(M) * std::log(double(M) / double(zeros)); // small range: linear counting
+        return e;
+    }
+
+    static constexpr size_t bytes() { return M; }
+};
+
+
+// ---------- KLL quantile sketch ----------
+
+class KllSketch
+{
+    size_t k;
+    std::vector<std::vector<float>> levels; // level i items have weight 2^i
+    std::mt19937_64 rng;
+    size_t count = 0;
+
+    // top level gets k, every level below 2/3 of the one above, at least 8
+    // level 0 is the batch buffer and always gets k, otherwise we would sort 8 values at a time for big sketches
+    size_t capacity(size_t level) const
+    {
+        if (level == 0) return k;
+        size_t depth = levels.size() - 1 - level;
+        return std::max<size_t>(8, size_t(double(k) * std::pow(2.0 / 3.0, double(depth))));
+    }
+
+    void compress()
+    {
+        for (size_t level = 0; level < levels.size(); level++)
+        {
+            if (levels[level].size() < capacity(level)) continue;
+            if (level + 1 == levels.size()) levels.emplace_back();
+            std::vector<float>& items = levels[level];
+            std::sort(items.begin(), items.end());
+            bool odd = items.size() % 2;
+            float leftover = items.back();
+            if (odd) items.pop_back(); // odd item count, one item stays on this level
+            size_t offset = rng() & 1; // random odd/even keeps the estimate unbiased
+            for (size_t i = offset; i < items.size(); i += 2) levels[level + 1].push_back(items[i]);
+            items.clear();
+            if (odd) items.push_back(leftover);
+        }
+    }
+
+public:
+    // every shard needs its own seed, with equal seeds all shards flip the same compaction coins and their errors add up
+    KllSketch(size_t k = 200, uint64_t seed = 42) : k(k), levels(1), rng(seed) {}
+
+    void update(const float* values, size_t n)
+    {
+        count += n;
+        while (n)
+        {
+            size_t room = capacity(0) > levels[0].size() ? capacity(0) - levels[0].size() : 0;
+            size_t take = std::min(n, std::max<size_t>(room, 1));
+            levels[0].insert(levels[0].end(), values, values + take);
+            values += take, n -= take;
+            if (levels[0].size() >= capacity(0)) compress();
+        }
+    }
+
+    void merge(const KllSketch& other)
+    {
+        while (levels.size() < other.levels.size()) levels.emplace_back();
+        for (size_t level = 0; level < other.levels.size(); level++)
+            levels[level].insert(levels[level].end(), other.levels[level].begin(), other.levels[level].end());
+        count += other.count;
+        compress();
+    }
+
+    float quantile(double q) const
+    {
+        std::vector<std::pair<float, uint64_t>> weighted;
+        uint64_t total = 0;
+        for (size_t level = 0; level < levels.size(); level++)
+            for (float v : levels[level]) weighted.push_back({ v, uint64_t(1) << level }), total += uint64_t(1) << level;
+        if (weighted.empty()) return 0.0f;
+        std::sort(weighted.begin(), weighted.end());
+        uint64_t target = uint64_t(q * double(total)), seen = 0;
+        for (auto& item : weighted)
+        {
+            seen += item.second;
+            if (seen > target) return item.first;
+        }
+        return weighted.back().first;
+    }
+
+    size_t retained() const
+    {
+        size_t items = 0;
+        for (auto& level : levels) items += level.size();
+        return items;
+    }
+};
+
+
+// ---------- per-thread build + merge ----------
+
+// make(t) creates the sketch of thread t, so randomized sketches can seed every thread differently
+template<typename Feed, typename Make>
+auto buildParallel(size_t parts, unsigned threads, Feed feed, Make make) -> decltype(make(0u))
+{
+    using Sketch = decltype(make(0u));
+    std::vector<Sketch> local;
+    for (unsigned t = 0; t < threads; t++) local.push_back(make(t));
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++)
+        workers.emplace_back([&, t] {
+            for (size_t part = t; part < parts; part += threads) feed(local[t], part);
+        });
+    for (auto& w : workers) w.join();
+    for (unsigned t = 1; t < threads; t++) local[0].merge(local[t]);
+    return local[0];
+}
+
+
+int main()
+{
+    const size_t N = 20'000'000;
+    const size_t CARDINALITY = 2'000'000; // distinct cell ids
+    const size_t SPAN = 64 * 1024;        // ParticlesSoA column is cut into spans of this many values
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    std::uniform_int_distribution<int> cell(0, int(CARDINALITY) - 1);
+    ParticlesSoA particles(N);
+    ChunkedVector<int, 4096> cellIds;
+    for (size_t i = 0; i < N; i++)
+    {
+        particles.x[i] = dist(rng) * dist(rng) / 1000.f; // not uniform, so quantiles are not trivial
+        cellIds.push_back(cell(rng));
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Sketches over " << N << " values, " << threads << " thread(s)\n\n";
+
+    // cardinality of cell ids, fed chunk by chunk from the ChunkedVector
+    auto start = Clock::now();
+    HyperLogLog<14> hll = buildParallel(cellIds.chunk_count(), threads,
+        [&](HyperLogLog<14>& sketch, size_t chunk) { sketch.update(cellIds.chunk_data(chunk), cellIds.chunk_size(chunk)); },
+        [](unsigned) { return HyperLogLog<14>(); });
+    std::chrono::duration<double> hllTime = Clock::now() - start;
+
+    start = Clock::now();
+    std::vector<int> copy(N);
+    for (size_t i = 0; i < N; i++) copy[i] = cellIds[i];
+    std::sort(copy.begin(), copy.end());
+    size_t exactDistinct = std::unique(copy.begin(), copy.end()) - copy.begin();
+    std::chrono::duration<double> exactDistinctTime = Clock::now() - start;
+
+    double estimate = hll.estimate();
+    std::cout << "HyperLogLog (" << HyperLogLog<14>::bytes() << " bytes)\n";
+    std::cout << "  estimate " << estimate << ", exact " << exactDistinct << ", error "
+        << 100.0 * (estimate - double(exactDistinct)) / double(exactDistinct) << " %\n";
+    std::cout << "  sketch " << N / hllTime.count() / 1e6 << " M values/s, exact (sort + unique) "
+        << N / exactDistinctTime.count() / 1e6 << " M values/s\n\n";
+
+    // quantiles of x, fed span by span from the SoA column
+    start = Clock::now();
+    size_t spans = (N + SPAN - 1) / SPAN;
+    KllSketch kll = buildParallel(spans, threads,
+        [&](KllSketch& sketch, size_t span) {
+            size_t begin = span * SPAN;
+            sketch.update(particles.x.data() + begin, std::min(SPAN, N - begin));
+        },
+        [](unsigned t) { return KllSketch(200, 42 + t); });
+    std::chrono::duration<double> kllTime = Clock::now() - start;
+
+    start = Clock::now();
+    std::vector<float> sorted = particles.x;
+    std::sort(sorted.begin(), sorted.end());
+    std::chrono::duration<double> exactQuantileTime = Clock::now() - start;
+
+    std::cout << "KLL quantile sketch (k = 200, " << kll.retained() << " values retained)\n";
+    std::cout << "  sketch " << N / kllTime.count() / 1e6 << " M values/s, exact (sort) "
+        << N / exactQuantileTime.count() / 1e6 << " M values/s\n";
+    for (double q : { 0.5, 0.9, 0.99 })
+    {
+        float value = kll.quantile(q);
+        double rank = double(std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin()) / double(N);
+        std::cout << "  p" << int(q * 100) << ": estimate " << std::setw(10) << value
+            << ", exact " << std::setw(10) << sorted[size_t(q * double(N - 1))]
+            << ", rank error " << 100.0 * (rank - q) << " %\n";
+    }
+    return 0;
+}
@@ -0,0 +1,479 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <fstream>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*/
+Sequential "push N, sum N" loops don't look like what a real service does with a container.
+Here we record the operations a run makes (push_back, get, scan, erase) into a compact binary trace,
+and replay the exact same trace against every container, so they are compared on the same workload.
+RecordingVector wraps a ChunkedVector (or the pooled one) and logs every operation the code using it makes.
+
+Trace file format (little endian, written byte by byte so files move between machines):
+  header: magic "CVTR", uint32 version, uint64 number of records
+  record: 1 byte opcode, then its arguments as LEB128 varints (small numbers take 1-2 bytes)
+    PUSH_BACK value | GET index | SCAN begin count | ERASE index
+*/
+
+enum class Op : uint8_t { PushBack = 0, Get = 1, Scan = 2, Erase = 3 };
+const char* opNames[] = { "push_back", "get", "scan", "erase" };
+
+struct TraceRecord
+{
+    Op op;
+    uint64_t a = 0, b = 0; // value/index/begin, count
+};
+
+
+// ---------- trace format ----------
+
+void writeLE(std::ostream& out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) out.put(char(uint8_t(value >> (8 * i))));
+}
+
+uint64_t readLE(std::istream& in, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) value |= uint64_t(uint8_t(in.get())) << (8 * i);
+    return value;
+}
+
+class TraceWriter
+{
+    std::vector<uint8_t> bytes;
+    uint64_t records = 0;
+
+    void varint(uint64_t v)
+    {
+        while (v >= 0x80) { bytes.push_back(uint8_t(v) | 0x80); v >>= 7; }
+        bytes.push_back(uint8_t(v));
+    }
+
+public:
+    void pushBack(uint64_t value) { bytes.push_back(uint8_t(Op::PushBack)); varint(value); records++; }
+    void get(uint64_t index) { bytes.push_back(uint8_t(Op::Get)); varint(index); records++; }
+    void scan(uint64_t begin, uint64_t count) { bytes.push_back(uint8_t(Op::Scan)); varint(begin); varint(count); records++; }
+    void erase(uint64_t index) { bytes.push_back(uint8_t(Op::Erase)); varint(index); records++; }
+
+    bool save(const std::string& path) const
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write("CVTR", 4);
+        writeLE(out, 1, 4); // version
+        writeLE(out, records, 8);
+        out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        return static_cast<bool>(out);
+    }
+
+    size_t sizeInBytes() const { return bytes.size() + 16; }
+};
+
+// decodes the whole file up front, so decoding cost is not part of the replay timing
+bool loadTrace(const std::string& path, std::vector<TraceRecord>& records)
+{
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    in.read(magic, 4);
+    uint64_t version = readLE(in, 4);
+    uint64_t count = readLE(in, 8);
+    if (!in || std::string(magic, 4) != "CVTR" || version != 1) return false;
+
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t pos = 0;
+    auto varint = [&](uint64_t& v) {
+        v = 0;
+        for (int shift = 0; pos < bytes.size() && shift < 64; shift += 7) // more than 10 bytes is a broken record
+        {
+            uint8_t byte = bytes[pos++];
+            v |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    };
+
+    records.clear();
+    records.reserve(std::min<uint64_t>(count, bytes.size() / 2)); // a record is at least 2 bytes, a broken count can't make us allocate terabytes
+    for (uint64_t i = 0; i < count; i++)
+    {
+        if (pos >= bytes.size()) return false;
+        TraceRecord r;
+        r.op = Op(bytes[pos++]);
+        if (r.op > Op::Erase || !varint(r.a)) return false;
+        if (r.op == Op::Scan && !varint(r.b)) return false;
+        records.push_back(r);
+    }
+    return true;
+}
+
+/*/
+Stand-in for a production recording: a fill phase followed by a mix of hot-spot reads (zipf-like, most reads hit a few
+recent elements), range scans, appends and occasional erases (also near the tail). The generator tracks the size so every index is valid.
+*/
+TraceWriter generateTrace(size_t initial, size_t operations)
+{
+    TraceWriter writer;
+    std::mt19937_64 rng(123);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    size_t size = 0;
+    for (; size < initial; size++) writer.pushBack(size);
+    auto nearTail = [&]() { // most accesses hit the tail, where recent data lives
+        size_t back = size_t(double(size) * std::pow(unit(rng), 4.0));
+        return size - 1 - std::min(back, size - 1);
+    };
+    for (size_t i = 0; i < operations; i++)
+    {
+        double p = unit(rng);
+        if (p < 0.60) writer.get(nearTail());
+        else if (p < 0.65)
+        {
+            size_t count = 1 + size_t(unit(rng) * 4096);
+            size_t begin = size_t(unit(rng) * double(size - std::min(count, size)));
+            writer.scan(begin, std::min(count, size - begin));
+        }
+        else if (p < 0.999) writer.pushBack(size++);
+        else if (size > 1) writer.erase(nearTail()), size--;
+    }
+    return writer;
+}
+
+
+// ---------- containers ----------
+
+template<typename T>
+class PoolAllocator
+{
+    std::vector<T*> buffers;
+    size_t capacity; // this is how many element we can store
+    size_t offset;   // this is how many we already use
+public:
+    PoolAllocator(size_t cap) : capacity(cap), offset(0) {
+        buffers.push_back(new T[cap]);
+    }
+
+    T* allocate(size_t n) {
+        if (offset + n > capacity)
+        {
+            buffers.push_back(new T[capacity]);
+            offset = 0;
+        }
+        T* ptr = buffers.back() + offset; // carve from the buffer
+        offset += n;
+        return ptr;
+    }
+
+    ~PoolAllocator() {
+        for (auto buffer : buffers) delete[] buffer;
+    }
+};
+
+/*/
+Same chunked vectors as in Vector_allocation_benhmarks, plus erase so they can replay a full trace.
+Erase shifts the tail left by one like std::vector does, chunk by chunk, and the last chunk stays allocated for reuse.
+*/
+template<typename T, size_t CHUNK_SIZE = 64>
+class ChunkedVector {
+    std::vector<T*> chunks;
+    size_t size = 0;
+
+public:
+    ~ChunkedVector() {
+        for (auto chunk : chunks) delete[] chunk;
+    }
+
+    void push_back(const T& value) {
+        if (size / CHUNK_SIZE == chunks.size())
+            chunks.push_back(new T[CHUNK_SIZE]);
+        chunks[size / CHUNK_SIZE][size % CHUNK_SIZE] = value;
+        size++;
+    }
+
+    T& operator[](size_t index) {
+        return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+
+    void erase(size_t index) {
+        for (size_t i = index; i + 1 < size; i++) (*this)[i] = (*this)[i + 1];
+        size--;
+    }
+
+    size_t get_size() const { return size; }
+};
+
+template<typename T, size_t CHUNK_SIZE = 64>
+class ChunkedVectorPoolAllocation
+{
+    std::vector<T*> chunks;
+    size_t size = 0;
+    PoolAllocator<T> allocator{ 2048 };
+
+public:
+    void push_back(const T& value)
+    {
+        if (size / CHUNK_SIZE == chunks.size()) chunks.push_back(allocator.allocate(CHUNK_SIZE));
+        chunks[size / CHUNK_SIZE][size % CHUNK_SIZE] = value;
+        size++;
+    }
+
+    T& operator[](size_t index) {
+        return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+
+    void erase(size_t index) {
+        for (size_t i = index; i + 1 < size; i++) (*this)[i] = (*this)[i + 1];
+        size--;
+    }
+
+    size_t get_size() const { return size; }
+};
+
+/*/
+Adapters give every container the same small interface, to add a newer container just add one more adapter
+and one more line in main.
+*/
+struct StdVectorAdapter
+{
+    std::vector<long long> v;
+    void push_back(long long value) { v.push_back(value); }
+    long long& operator[](size_t i) { return v[i]; }
+    void erase(size_t i) { v.erase(v.begin() + i); }
+    size_t size() const { return v.size(); }
+};
+
+template<typename Container>
+struct ChunkedAdapter
+{
+    Container v;
+    void push_back(long long value) { v.push_back(value); }
+    long long& operator[](size_t i) { return v[i]; }
+    void erase(size_t i) { v.erase(i); }
+    size_t size() const { return v.get_size(); }
+};
+
+
+// ---------- recording ----------
+
+/*/
+Drop-in for a ChunkedVector in real code: every call is forwarded to the wrapped container and logged to the writer.
+Loops over a range should use forRange, then the trace gets one SCAN instead of one GET per element.
+*/
+template<typename T, typename Container = ChunkedVector<T>>
+class RecordingVector
+{
+    Container v;
+    TraceWriter& writer;
+
+public:
+    explicit RecordingVector(TraceWriter& writer) : writer(writer) {}
+
+    void push_back(const T& value) { writer.pushBack(uint64_t(value)); v.push_back(value); }
+    T& operator[](size_t index) { writer.get(index); return v[index]; }
+    void erase(size_t index) { writer.erase(index); v.erase(index); }
+    size_t get_size() const { return v.get_size(); }
+
+    template<typename F>
+    void forRange(size_t begin, size_t count, F f)
+    {
+        writer.scan(begin, count);
+        for (size_t i = begin; i < begin + count; i++) f(v[i]);
+    }
+};
+
+/*/
+A production-like run recorded through RecordingVector: a sensor service keeps its readings in a ChunkedVector,
+- appends a reading every step and compares it with the previous one (spike detection)
+- every 64 steps sums the last 1024 readings (moving average for the dashboard)
+- now and then looks up an older reading for a client query, recent ones much more often
+- drops readings flagged as faulty a bit later, they are near the tail
+The ops come from what this code does, not from a distribution we picked for the trace.
+*/
+template<typename Vector>
+size_t sensorService(Vector& readings, size_t initial, size_t steps)
+{
+    std::mt19937_64 rng(321);
+    std::normal_distribution<double> noise(0.0, 50.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    long long level = 1000;
+    size_t spikes = 0;
+    std::vector<size_t> faulty; // indices of readings to drop
+    for (size_t i = 0; i < initial; i++) readings.push_back(level + (long long)noise(rng));
+    for (size_t step = 0; step < steps; step++)
+    {
+        level += (long long)(noise(rng) / 25.0);
+        long long reading = level + (long long)noise(rng);
+        readings.push_back(reading);
+        size_t size = readings.get_size();
+        long long previous = size > 1 ? readings[size - 2] : reading;
+        if (std::llabs(reading - previous) > 250) spikes++;
+        if (unit(rng) < 0.0005) faulty.push_back(size - 1);
+
+        if (step % 64 == 0)
+        {
+            long long sum = 0;
+            size_t count = std::min<size_t>(size, 1024); // fewer readings than the window early on
+            readings.forRange(size - count, count, [&](long long value) { sum += value; });
+            if (sum == 0) spikes++;
+        }
+        if (unit(rng) < 0.3) // client query, how far back is skewed to recent readings
+        {
+            size_t back = size_t(double(size) * std::pow(unit(rng), 6.0));
+            if (readings[size - 1 - std::min(back, size - 1)] > level + 500) spikes++;
+        }
+        if (!faulty.empty() && size - faulty.front() > 4096)
+        {
+            readings.erase(faulty.front());
+            faulty.erase(faulty.begin());
+            for (auto& index : faulty) index--; // they moved one to the left
+        }
+    }
+    return spikes;
+}
+
+
+// ---------- replay ----------
+
+// indices are taken modulo size, so traces recorded elsewhere can't crash the replay
+template<typename Container>
+inline long long apply(Container& c, const TraceRecord& r)
+{
+    size_t size = c.size();
+    switch (r.op)
+    {
+    case Op::PushBack: c.push_back((long long)r.a); return 0;
+    case Op::Get: return size ? c[r.a % size] : 0;
+    case Op::Scan:
+    {
+        if (!size) return 0;
+        long long sum = 0;
+        size_t begin = r.a % size, end = std::min<size_t>(size, begin + r.b);
+        for (size_t i = begin; i < end; i++) sum += c[i];
+        return sum;
+    }
+    case Op::Erase: if (size) c.erase(r.a % size); return 0;
+    }
+    return 0;
+}
+
+struct ReplayResult
+{
+    double seconds;
+    double p50, p99, p999; // per-op latency in nanoseconds
+};
+
+template<typename Container>
+ReplayResult replay(const std::vector<TraceRecord>& trace, int repeats = 3)
+{
+    ReplayResult result{ 1e300, 0, 0, 0 };
+    volatile long long sink = 0;
+
+    // throughput pass without per-op timers, best of repeats
+    for (int r = 0; r < repeats; r++)
+    {
+        Container c;
+        auto start = Clock::now();
+        long long sum = 0;
+        for (const TraceRecord& record : trace) sum += apply(c, record);
+        std::chrono::duration<double> duration = Clock::now() - start;
+        result.seconds = std::min(result.seconds, duration.count());
+        sink = sink + sum;
+    }
+
+    // latency pass, timer around every op
+    Container c;
+    std::vector<double> latencies;
+    latencies.reserve(trace.size());
+    for (const TraceRecord& record : trace)
+    {
+        auto start = Clock::now();
+        sink = sink + apply(c, record);
+        std::chrono::duration<double, std::nano> duration = Clock::now() - start;
+        latencies.push_back(duration.count());
+    }
+    auto percentile = [&](double p) {
+        size_t k = std::min(latencies.size() - 1, size_t(p * double(latencies.size())));
+        std::nth_element(latencies.begin(), latencies.begin() + k, latencies.end());
+        return latencies[k];
+    };
+    if (!latencies.empty())
+    {
+        result.p50 = percentile(0.50);
+        result.p99 = percentile(0.99);
+        result.p999 = percentile(0.999);
+    }
+    return result;
+}
+
+void printRow(const std::string& name, const ReplayResult& r, size_t ops)
+{
+    std::cout << std::setw(26) << name
+        << std::setw(14) << double(ops) / r.seconds / 1e6
+        << std::setw(12) << r.p50
+        << std::setw(12) << r.p99
+        << std::setw(12) << r.p999
+        << "\n";
+}
+
+/*/
+Usage:
+  trace-replay                      generate a synthetic trace in memory and replay it
+  trace-replay record file.trc      run sensorService on a RecordingVector and write what it did to a file
+  trace-replay synthetic file.trc   write the synthetic trace to a file
+  trace-replay file.trc             replay a recorded trace
+*/
+int main(int argc, char** argv)
+{
+    const size_t INITIAL = 1'000'000, OPERATIONS = 2'000'000;
+    std::vector<TraceRecord> trace;
+    std::string path = "synthetic.trc";
+
+    if (argc >= 3 && std::string(argv[1]) == "record")
+    {
+        TraceWriter writer;
+        RecordingVector<long long> readings(writer);
+        size_t spikes = sensorService(readings, INITIAL, OPERATIONS / 2);
+        if (!writer.save(argv[2])) { std::cerr << "could not write " << argv[2] << "\n"; return 1; }
+        std::cout << "recorded sensorService (" << spikes << " spikes) to " << argv[2] << " (" << writer.sizeInBytes() << " bytes)\n";
+        return 0;
+    }
+    if (argc >= 3 && std::string(argv[1]) == "synthetic")
+    {
+        TraceWriter writer = generateTrace(INITIAL, OPERATIONS);
+        if (!writer.save(argv[2])) { std::cerr << "could not write " << argv[2] << "\n"; return 1; }
+        std::cout << "wrote " << argv[2] << " (" << writer.sizeInBytes() << " bytes)\n";
+        return 0;
+    }
+    if (argc >= 2) path = argv[1];
+    else
+    {
+        // no trace given: round trip the synthetic one through the file format
+        TraceWriter writer = generateTrace(INITIAL, OPERATIONS);
+        writer.save(path);
+    }
+    if (!loadTrace(path, trace)) { std::cerr << "could not read trace " << path << "\n"; return 1; }
+
+    size_t counts[4] = {};
+    for (auto& r : trace) counts[size_t(r.op)]++;
+    std::cout << "Trace " << path << ": " << trace.size() << " ops (";
+    for (int i = 0; i < 4; i++) std::cout << (i ? ", " : "") << opNames[i] << " " << counts[i];
+    std::cout << ")\n\n";
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(26) << "Container"
+        << std::setw(14) << "Mops/s"
+        << std::setw(12) << "p50 ns"
+        << std::setw(12) << "p99 ns"
+        << std::setw(12) << "p99.9 ns"
+        << "\n";
+    printRow("std::vector", replay<StdVectorAdapter>(trace), trace.size());
+    printRow("ChunkedVector", replay<ChunkedAdapter<ChunkedVector<long long>>>(trace), trace.size());
+    printRow("ChunkedVector (pooled)", replay<ChunkedAdapter<ChunkedVectorPoolAllocation<long long>>>(trace), trace.size());
+    return 0;
+}
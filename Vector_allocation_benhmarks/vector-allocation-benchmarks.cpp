@@ -2,10 +2,170 @@
 #include <vector>
 #include <chrono>
 #include <iomanip>
+#include <fstream>
+#include <string>
+#include <atomic>
+#include <thread>
 
 
 using Clock = std::chrono::high_resolution_clock;
 
+// ENERGY READING AND RAPL METER (same as in AoS-SoA)
+struct EnergyReading
+{
+    double packageJoules = 0;
+    double dramJoules = 0;
+    bool packageValid = true; // false if a counter wrapped and we don't know its range, the joules are meaningless then
+    bool dramValid = true;
+
+    void add(const EnergyReading& run)
+    {
+        packageJoules += run.packageJoules, dramJoules += run.dramJoules;
+        packageValid &= run.packageValid, dramValid &= run.dramValid;
+    }
+
+    EnergyReading averaged(int runs) const
+    {
+        EnergyReading r = *this;
+        r.packageJoules /= runs, r.dramJoules /= runs;
+        return r;
+    }
+};
+
+class RaplMeter
+{
+    struct Domain
+    {
+        std::string path;
+        bool dram;
+        unsigned long long maxRange;
+        unsigned long long start = 0;
+    };
+    std::vector<Domain> domains;
+
+    static bool readValue(const std::string& file, unsigned long long& value)
+    {
+        std::ifstream in(file);
+        return static_cast<bool>(in >> value);
+    }
+
+public:
+    RaplMeter()
+    {
+        for (int pkg = 0; pkg < 16; pkg++)
+        {
+            std::string base = "/sys/class/powercap/intel-rapl:" + std::to_string(pkg);
+            for (int sub = -1; sub < 8; sub++)
+            {
+                std::string dir = sub < 0 ? base : base + ":" + std::to_string(sub);
+                std::ifstream nameFile(dir + "/name");
+                std::string name;
+                if (!(nameFile >> name)) continue;
+                bool isPackage = name.rfind("package", 0) == 0;
+                bool isDram = name == "dram";
+                if (!isPackage && !isDram) continue; // core/uncore are already counted in the package
+                unsigned long long value, maxRange;
+                if (!readValue(dir + "/energy_uj", value)) continue; // usually root-only on newer kernels
+                if (!readValue(dir + "/max_energy_range_uj", maxRange)) maxRange = 0;
+                domains.push_back({ dir + "/energy_uj", isDram, maxRange });
+            }
+        }
+    }
+
+    bool available() const { return !domains.empty(); }
+
+    void start()
+    {
+        for (auto& d : domains) readValue(d.path, d.start);
+    }
+
+    EnergyReading stop()
+    {
+        EnergyReading reading;
+        for (auto& d : domains)
+        {
+            unsigned long long now = d.start;
+            readValue(d.path, now);
+            if (now < d.start && d.maxRange == 0) // wrapped, but max_energy_range_uj wasn't readable
+            {
+                (d.dram ? reading.dramValid : reading.packageValid) = false;
+                continue;
+            }
+            unsigned long long delta = now >= d.start ? now - d.start : now + d.maxRange - d.start; // counter wrapped around
+            (d.dram ? reading.dramJoules : reading.packageJoules) += delta * 1e-6;
+        }
+        return reading;
+    }
+};
+
+/*/
+Runtime statistics for production telemetry.
+Containers and the allocator take a Stats policy as last template parameter:
+- NoStats (default) has empty inline functions and no data, we inherit from it so it takes no space, and the compiler removes every call
+- RelaxedStats counts operations in per-thread shards of relaxed atomics, each shard on its own cache line,
+  so threads reading the same container don't fight over one counter
+Structural numbers (buffers, chunks, bytes) are computed from the container itself on stats(), so they cost nothing during normal use.
+stats() returns a plain struct that can be pushed to any metrics system.
+*/
+enum Counter { PUSH_BACK, ACCESS, ALLOCATE, NEW_BUFFER, COUNTER_COUNT };
+
+struct OpCounters
+{
+    unsigned long long pushBacks = 0, accesses = 0, allocations = 0, newBuffers = 0;
+};
+
+class NoStats
+{
+public:
+    void count(Counter) {}
+    OpCounters counters() const { return {}; }
+};
+
+class RelaxedStats
+{
+    static constexpr size_t SHARDS = 16;
+    struct alignas(64) Shard
+    {
+        std::atomic<unsigned long long> values[COUNTER_COUNT] = {};
+    };
+    Shard shards[SHARDS];
+
+    static size_t threadShard()
+    {
+        static std::atomic<size_t> nextThread{ 0 };
+        thread_local size_t shard = nextThread.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+        return shard;
+    }
+
+public:
+    void count(Counter c) { shards[threadShard()].values[c].fetch_add(1, std::memory_order_relaxed); }
+
+    OpCounters counters() const
+    {
+        unsigned long long totals[COUNTER_COUNT] = {};
+        for (auto& shard : shards)
+            for (int c = 0; c < COUNTER_COUNT; c++) totals[c] += shard.values[c].load(std::memory_order_relaxed);
+        return { totals[PUSH_BACK], totals[ACCESS], totals[ALLOCATE], totals[NEW_BUFFER] };
+    }
+};
+
+struct PoolAllocatorStats
+{
+    size_t buffers = 0;
+    size_t bytesReserved = 0;
+    size_t bytesUsed = 0;
+    OpCounters ops;
+};
+
+struct ChunkedVectorStats
+{
+    size_t size = 0;
+    size_t chunks = 0;
+    double fillRatio = 0; // elements / chunk capacity
+    OpCounters ops;
+    PoolAllocatorStats pool; // only filled for the pooled chunked vector
+};
+
 /*/
 When we use new[], the OS may scatter allocations across memory.
 By making our own pool allocator, everything lives in one contiguous buffer which results in much better spatial locality and that improves cache hits.
@@ -14,21 +174,25 @@ With pool allocator, you never free individual object, either we free all at onc
 Like this we avoid fragmentation entirely because allocation is always linear.
 */
 
-template<typename T>
-class PoolAllocator
+template<typename T, typename Stats = NoStats>
+class PoolAllocator : private Stats
 {
     std::vector<T*> buffers;
     size_t capacity; // this is how many element we can store
     size_t offset;   // this is how many we already use
+    size_t usedInFullBuffers = 0; // elements carved from older buffers, their unused tails are lost
 public:
     PoolAllocator(size_t cap) : capacity(cap), offset(0) {
         buffers.push_back(new T[cap]);
     }
 
     T* allocate(size_t n) {
+        Stats::count(ALLOCATE);
         if (offset + n > capacity)
         {
             buffers.push_back(new T[capacity]);
+            Stats::count(NEW_BUFFER);
+            usedInFullBuffers += offset;
             offset = 0;
         }
         T* ptr = buffers.back() + offset; // carve from the buffer
@@ -36,6 +200,15 @@ public:
         return ptr;
     }
 
+    PoolAllocatorStats stats() const {
+        PoolAllocatorStats s;
+        s.buffers = buffers.size();
+        s.bytesReserved = buffers.size() * capacity * sizeof(T);
+        s.bytesUsed = (usedInFullBuffers + offset) * sizeof(T);
+        s.ops = Stats::counters();
+        return s;
+    }
+
     ~PoolAllocator() {
         for (auto buffer : buffers)
         {
@@ -56,8 +229,8 @@ Chunked vectors are cache friendly and we avoid huge allocations.
 
 
 //CHUNKED VECTOR WITH NEW[] 
-template<typename T, size_t CHUNK_SIZE = 64>
-class ChunkedVector {
+template<typename T, size_t CHUNK_SIZE = 64, typename Stats = NoStats>
+class ChunkedVector : private Stats {
     std::vector<T*> chunks;
     size_t size = 0;
 
@@ -67,6 +240,7 @@ public:
     }
 
     void push_back(const T& value) {
+        Stats::count(PUSH_BACK);
         if (size % CHUNK_SIZE == 0)
             chunks.push_back(new T[CHUNK_SIZE]);
         chunks[size / CHUNK_SIZE][size % CHUNK_SIZE] = value;
@@ -74,85 +248,136 @@ public:
     }
 
     T& operator[](size_t index) {
+        Stats::count(ACCESS);
         return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
     }
 
     size_t get_size() const { return size; }
+
+    ChunkedVectorStats stats() const {
+        ChunkedVectorStats s;
+        s.size = size;
+        s.chunks = chunks.size();
+        s.fillRatio = chunks.empty() ? 0.0 : double(size) / double(chunks.size() * CHUNK_SIZE);
+        s.ops = Stats::counters();
+        return s;
+    }
 };
 
 
 //CHUNKED VECTOR WITH POOL ALLOCATION
 
-template<typename T, size_t CHUNK_SIZE = 64> // CHUNK_SIZE - number of elements in each chunk, can be modified 
-class ChunkedVectorPoolAllocation
+template<typename T, size_t CHUNK_SIZE = 64, typename Stats = NoStats> // CHUNK_SIZE - number of elements in each chunk, can be modified 
+class ChunkedVectorPoolAllocation : private Stats
 {
     std::vector<T*> chunks; // here each pointer points to a chunk
     size_t size = 0;
-    PoolAllocator<T> allocator{ 2048 }; // we use our custom allocator
+    PoolAllocator<T, Stats> allocator{ 2048 }; // we use our custom allocator
 
 public:
 
     void push_back(const T& value)
     {
+        Stats::count(PUSH_BACK);
         if (size % CHUNK_SIZE == 0) chunks.push_back(allocator.allocate(CHUNK_SIZE)); // size is counter for elements in ChunkedVector, when we reach number thats divisible by CHUNK_SIZE we create new chunk
         chunks[size / CHUNK_SIZE][size % CHUNK_SIZE] = value;
         size++;
     }
 
     T& operator[](size_t index) {
+        Stats::count(ACCESS);
         return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
     }
 
     size_t get_size() const { return size; }
+
+    ChunkedVectorStats stats() const {
+        ChunkedVectorStats s;
+        s.size = size;
+        s.chunks = chunks.size();
+        s.fillRatio = chunks.empty() ? 0.0 : double(size) / double(chunks.size() * CHUNK_SIZE);
+        s.ops = Stats::counters();
+        s.pool = allocator.stats();
+        return s;
+    }
 };
 
+void printStats(const std::string& name, const ChunkedVectorStats& s)
+{
+    std::cout << name << ": size " << s.size << ", chunks " << s.chunks << ", fill ratio " << s.fillRatio
+        << ", push_backs " << s.ops.pushBacks << ", accesses " << s.ops.accesses;
+    if (s.pool.buffers)
+        std::cout << "\n    pool: buffers " << s.pool.buffers << ", bytes reserved " << s.pool.bytesReserved
+            << ", bytes used " << s.pool.bytesUsed << ", allocations " << s.pool.ops.allocations
+            << ", new buffers " << s.pool.ops.newBuffers;
+    std::cout << "\n";
+}
+
 
-double benchmarkStdVector(size_t n = 10'000'000, int repeat = 5) {
+double benchmarkStdVector(size_t n = 10'000'000, int repeat = 5, EnergyReading* energy = nullptr) {
+    RaplMeter meter;
+    EnergyReading total;
     double bestTime = 1e300;
     for (size_t i = 0; i < repeat; i++)
     {
+        meter.start();
         auto start = Clock::now();
         std::vector<int> v;
         v.reserve(n);
         for (size_t k = 0; k < n; k++) v.push_back(k);
         volatile long long sum = 0;
-        for (size_t k = 0; k < v.size(); i++) sum += v[i];
+        for (size_t k = 0; k < v.size(); k++) sum += v[k];
         auto end = Clock::now();
+        EnergyReading run = meter.stop();
+        total.add(run);
         std::chrono::duration<double> duration = end - start;
         bestTime = std::min(bestTime, duration.count());
     }
+    if (energy) *energy = total.averaged(repeat);
     return bestTime;
 }
 
-double benchmarkChunkedVector(size_t n = 10'000'000, int repeat = 5) {
-    double bestTime;
+double benchmarkChunkedVector(size_t n = 10'000'000, int repeat = 5, EnergyReading* energy = nullptr) {
+    RaplMeter meter;
+    EnergyReading total;
+    double bestTime = 1e300;
     for (size_t i = 0; i < repeat; i++)
     {
+        meter.start();
         auto start = Clock::now();
         ChunkedVector<int> v;
         for (size_t k = 0; k < n; k++) v.push_back(k);
         volatile long long sum = 0;
         for (size_t k = 0; k < v.get_size(); k++) sum += v[k];
         auto end = Clock::now();
+        EnergyReading run = meter.stop();
+        total.add(run);
         std::chrono::duration<double> duration = end - start;
         bestTime = std::min(bestTime, duration.count());
     }
+    if (energy) *energy = total.averaged(repeat);
     return bestTime;
 }
 
-double benchmarkChunkedVectorPooled(size_t n) {
-    double bestTime;
+double benchmarkChunkedVectorPooled(size_t n = 10'000'000, int repeat = 5, EnergyReading* energy = nullptr) {
+    RaplMeter meter;
+    EnergyReading total;
+    double bestTime = 1e300;
     for (size_t i = 0; i < repeat; i++)
     {
+        meter.start();
         auto start = Clock::now();
         ChunkedVectorPoolAllocation<int> v;
         for (size_t k = 0; k < n; k++) v.push_back(k);
         volatile long long sum = 0;
         for (size_t k = 0; k < v.get_size(); k++) sum += v[k];
         auto end = Clock::now();
+        EnergyReading run = meter.stop();
+        total.add(run);
         std::chrono::duration<double> duration = end - start;
         bestTime = std::min(bestTime, duration.count());
     }
+    if (energy) *energy = total.averaged(repeat);
     return bestTime;
 }
 
@@ -170,10 +395,13 @@ int main()
         << std::setw(20) << "Speedup (pooled/std)"
         << "\n";
 
+    std::vector<EnergyReading> energies; // 3 per size, printed after the timing table
     for (size_t N : testSizes) {
-        double t1 = benchmarkStdVector(N);
-        double t2 = benchmarkChunkedVector(N);
-        double t3 = benchmarkChunkedVectorPooled(N);
+        EnergyReading e1, e2, e3;
+        double t1 = benchmarkStdVector(N, 5, &e1);
+        double t2 = benchmarkChunkedVector(N, 5, &e2);
+        double t3 = benchmarkChunkedVectorPooled(N, 5, &e3);
+        energies.insert(energies.end(), { e1, e2, e3 });
 
         std::cout << std::setw(12) << N
             << std::setw(15) << t1
@@ -183,5 +411,45 @@ int main()
             << "\n";
     }
 
+    // telemetry snapshot with stats turned on (the benchmarks above use the default NoStats)
+    {
+        const size_t N = 1'000'000;
+        ChunkedVector<int, 64, RelaxedStats> v;
+        ChunkedVectorPoolAllocation<int, 64, RelaxedStats> pooled;
+        volatile long long sum = 0;
+        for (size_t k = 0; k < N; k++) v.push_back(k), pooled.push_back(k);
+        for (size_t k = 0; k < N; k++) sum += v[k] + pooled[k];
+        std::cout << "\nRuntime stats (RelaxedStats policy)\n";
+        printStats("ChunkedVector", v.stats());
+        printStats("ChunkedVector (pooled)", pooled.stats());
+    }
+
+    if (!RaplMeter().available())
+    {
+        std::cout << "\nEnergy: RAPL counters not available, skipping\n";
+        return 0;
+    }
+
+    std::cout << "\nEnergy per element (nJ, package + dram)\n\n";
+    std::cout << std::setw(12) << "N"
+        << std::setw(25) << "std::vector"
+        << std::setw(25) << "ChunkedVector"
+        << std::setw(25) << "ChunkedVector (pooled)"
+        << "\n";
+    for (size_t i = 0; i < testSizes.size(); i++) {
+        std::cout << std::setw(12) << testSizes[i];
+        for (size_t j = 0; j < 3; j++) {
+            const EnergyReading& e = energies[i * 3 + j];
+            auto cell = [&](int width, double joules, bool valid) { // n/a when a counter wrapped with unknown range
+                if (valid) std::cout << std::setw(width) << joules / testSizes[i] * 1e9;
+                else std::cout << std::setw(width) << "n/a";
+            };
+            cell(12, e.packageJoules, e.packageValid);
+            std::cout << " + ";
+            cell(10, e.dramJoules, e.dramValid);
+        }
+        std::cout << "\n";
+    }
+
     return 0;
 }